@@ -0,0 +1,31 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef CALLBACK_TABLE_H
+#define CALLBACK_TABLE_H
+
+#include "iotHubClient.h"
+
+// open addressing table, it doubles whenever it would get more than half full so probes
+// stay short, a zeroed table is empty and allocates on the first registration
+#define CALLBACK_TABLE_MIN_SIZE 16
+
+typedef struct CALLBACK_ENTRY_TAG {
+    uint32_t hash;
+    char *name;
+    methodCallback callback;
+} CALLBACK_ENTRY;
+
+// collisions is the number of entries that are not in their home slot
+typedef struct CALLBACK_TABLE_TAG {
+    CALLBACK_ENTRY *entries;
+    int size;
+    int count;
+    int collisions;
+} CALLBACK_TABLE;
+
+bool callbackTableAdd(CALLBACK_TABLE *table, const char *name, methodCallback callback);
+methodCallback callbackTableFind(CALLBACK_TABLE *table, const char *name);
+int callbackTableCollisions(CALLBACK_TABLE *table);
+
+#endif /* CALLBACK_TABLE_H */
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef CBOR_WRITER_H
+#define CBOR_WRITER_H
+
+// writes RFC 7049 CBOR straight into a caller supplied buffer, no heap allocations
+// maps and arrays are indefinite length so they can be merged and spliced like JSON text
+typedef struct CBOR_WRITER_TAG {
+    uint8_t *buffer;
+    int size;
+    int length;
+    bool overflow;
+} CBOR_WRITER;
+
+void cborWriterInit(CBOR_WRITER *writer, uint8_t *buffer, int size);
+
+void cborWriterBeginMap(CBOR_WRITER *writer, const char *key);
+void cborWriterEndMap(CBOR_WRITER *writer);
+void cborWriterBeginArray(CBOR_WRITER *writer, const char *key);
+void cborWriterEndArray(CBOR_WRITER *writer);
+
+void cborWriterAddInt(CBOR_WRITER *writer, const char *key, int value);
+void cborWriterAddFloat(CBOR_WRITER *writer, const char *key, float value);
+void cborWriterAddString(CBOR_WRITER *writer, const char *key, const char *value);
+void cborWriterAddMembers(CBOR_WRITER *writer, const uint8_t *map, int length);
+
+int cborWriterLength(CBOR_WRITER *writer);
+void cborWriterTruncate(CBOR_WRITER *writer, int length);
+bool cborWriterOverflow(CBOR_WRITER *writer);
+
+#endif /* CBOR_WRITER_H */
@@ -9,14 +9,17 @@ void clearAllConfig();
 void storeWiFi(const char *ssid, const char *password);
 void storeConnectionString(const char *connectionString);
 void storeIotCentralConfig(const char *iotCentralConfig, int size);
+void storeTwinCache(const uint8_t *twinCache, int size);
 
 void readWiFi(char* ssid, int ssidLen, char *password, int passwordLen);
 String readConnectionString();
 String readIotCentralConfig();
+void readTwinCache(uint8_t *twinCache, int size);
 
 void clearWiFiEEPROM();
 void clearAzureEEPROM();
 void clearIotCentralEEPROM();
+void clearTwinCacheEEPROM();
 
 #endif /* CONFIG_H */
 
@@ -26,3 +29,18 @@ void clearIotCentralEEPROM();
 #define ACCEL_CHECKED 0x10
 #define GYRO_CHECKED 0x08
 #define MAG_CHECKED 0x04
+
+// the optional 4th config byte, the top bit is always set so the byte never ends the config string
+#define OPTIONS_PRESENT 0x80
+#define CBOR_CHECKED 0x01
+
+// after the options byte one deadband per sensor in the bit order above, then the heartbeat
+// in minutes, each stored as value + 1 so the config string never holds a 0
+#define DEADBAND_CONFIG_OFFSET 4
+#define DEADBAND_CONFIG_LEN 7
+#define DEADBAND_VALUE_MAX 254
+
+// after the heartbeat the samples sent in one telemetry event and the longest the oldest
+// of them waits for the rest in seconds, stored the same way, 0 picks the default
+#define BATCH_CONFIG_OFFSET (DEADBAND_CONFIG_OFFSET + DEADBAND_CONFIG_LEN)
+#define BATCH_CONFIG_LEN 2
@@ -0,0 +1,17 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef DEADBAND_H
+#define DEADBAND_H
+
+// one threshold per sensor in config bit order: temp, humidity, pressure, accelerometer, gyroscope, magnetometer
+#define DEADBAND_SENSOR_COUNT 6
+
+// a heartbeat of 0 uses this one, so a channel inside its deadband is still sent now and then
+#define DEADBAND_HEARTBEAT_DEFAULT (15 * 60000UL)
+
+void deadbandConfigure(const uint8_t *sensorThresholds, unsigned long heartbeat);
+void deadbandClear();
+bool deadbandCheck(int channel, float value, unsigned long now);
+
+#endif /* DEADBAND_H */
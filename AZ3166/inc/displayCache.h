@@ -0,0 +1,25 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef DISPLAY_CACHE_H
+#define DISPLAY_CACHE_H
+
+#define DISPLAY_LINES 4
+#define DISPLAY_LINE_CHARS 16
+
+// each character is 8 columns of two SSD1306 pages, a clean writes the whole 128x64 panel
+#define DISPLAY_CHAR_BYTES 16
+#define DISPLAY_CLEAN_BYTES 1024
+
+void displayLock();
+void displayUnlock();
+void displayPrint(int line, const char *text);
+void displayInvalidate();
+void displayMessage(const char *title, const char *text, unsigned long holdTime);
+bool displayHeld();
+
+void clearDisplayStats();
+unsigned long getDisplayBytesWritten();
+unsigned long getDisplayBytesSavedPerSecond();
+
+#endif /* DISPLAY_CACHE_H */
@@ -0,0 +1,20 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef INBOUND_MESSAGE_H
+#define INBOUND_MESSAGE_H
+
+// C2D messages and direct method payloads are copied once into a fixed buffer and
+// parsed in place from it, strings in the parsed tree point into the buffer
+#define INBOUND_MESSAGE_MAX 1024
+
+// the parsed tree itself lives in a fixed arena, enough for the payloads IoT Central sends
+// but not for every message that fits the buffer, a member costs up to 16 arena bytes for
+// as little as 5 message bytes, messages that do not parse in it are rejected
+#define INBOUND_JSON_ARENA 1024
+
+bool inboundMessageCopy(const char *text, int length);
+char *inboundMessageText();
+int inboundMessageLength();
+
+#endif /* INBOUND_MESSAGE_H */
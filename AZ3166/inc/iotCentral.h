@@ -6,6 +6,15 @@
 
 #define IOT_CENTRAL_ZONE_IDX      0x02
 #define IOT_CENTRAL_MAX_LEN       128
+#define TWIN_CACHE_ZONE_IDX       0x08
+#define TWIN_CACHE_MAX_LEN        128
 #define FW_VERSION                "1.0-MSIOTC"
 
+#define TELEMETRY_PAYLOAD_MAX     1024
+
+typedef enum {
+    TELEMETRY_JSON,
+    TELEMETRY_CBOR
+} TelemetryEncoding;
+
 #endif /* IOT_CENTRAL_H */
\ No newline at end of file
@@ -1,19 +1,32 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. 
 
-typedef int (*methodCallback)(const char *, size_t, char **response, size_t* resp_size);
+#include <ArduinoJson.h>
+
+// handlers get a view into the already parsed message and write their response text into
+// the bounded response buffer, both are only valid for the duration of the call
+typedef int (*methodCallback)(JsonObject& payload, char *response, size_t responseSize);
 
 #ifndef IOT_HUB_CLIENT_H
 #define IOT_HUB_CLIENT_H
 
+#include "iotCentral.h"
+
+// approximate MQTT publish header, topic with properties and TLS record overhead of one event
+#define TELEMETRY_MESSAGE_OVERHEAD 110
+
 void initIotHubClient(bool traceOn);
-bool sendTelemetry(const char *payload);
+bool binaryEventsSupported();
+bool sendTelemetry(const char *payload, int length, time_t timestamp, TelemetryEncoding encoding);
 bool sendReportedProperty(const char *payload);
-void echoDesiredProperty(void);
+void checkIotHubClient();
 
 bool registerMethod(const char *methodName, methodCallback callback);
 bool registerDesiredProperty(const char *propertyName, methodCallback callback);
+int getCallbackCollisions();
 
+void processInbound(void);
+void closeInbound(void);
 void closeIotHubClient(void);
 
 void displayDeviceInfo();
@@ -0,0 +1,37 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#define JSON_WRITER_MAX_DEPTH 4
+
+// writes JSON straight into a caller supplied buffer, no heap allocations
+typedef struct JSON_WRITER_TAG {
+    char *buffer;
+    int size;
+    int length;
+    int depth;
+    bool firstValue[JSON_WRITER_MAX_DEPTH];
+    bool overflow;
+} JSON_WRITER;
+
+void jsonWriterInit(JSON_WRITER *writer, char *buffer, int size);
+
+void jsonWriterBeginObject(JSON_WRITER *writer, const char *key);
+void jsonWriterEndObject(JSON_WRITER *writer);
+void jsonWriterBeginArray(JSON_WRITER *writer, const char *key);
+void jsonWriterEndArray(JSON_WRITER *writer);
+
+void jsonWriterAddInt(JSON_WRITER *writer, const char *key, int value);
+void jsonWriterAddUnsigned(JSON_WRITER *writer, const char *key, unsigned long value);
+void jsonWriterAddFloat(JSON_WRITER *writer, const char *key, float value);
+void jsonWriterAddString(JSON_WRITER *writer, const char *key, const char *value);
+void jsonWriterAddRaw(JSON_WRITER *writer, const char *key, const char *json);
+void jsonWriterAddMembers(JSON_WRITER *writer, const char *object, int length);
+
+int jsonWriterLength(JSON_WRITER *writer);
+void jsonWriterTruncate(JSON_WRITER *writer, int length);
+bool jsonWriterOverflow(JSON_WRITER *writer);
+
+#endif /* JSON_WRITER_H */
@@ -8,4 +8,6 @@ void telemetrySetup(String iotCentralConfig);
 void telemetryLoop();
 void telemetryCleanup();
 
+void setSamplingInterval(unsigned long interval);
+
 #endif /* MAIN_TELEMETRY_H */
\ No newline at end of file
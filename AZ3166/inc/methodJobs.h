@@ -0,0 +1,17 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef METHOD_JOBS_H
+#define METHOD_JOBS_H
+
+#define METHOD_JOB_MAX 4
+#define METHOD_JOB_NAME_MAX 32
+
+// long running method work, called once per scheduler tick until it returns false
+typedef bool (*methodJobStep)(void *context);
+
+int startMethodJob(const char *methodName, methodJobStep step, void *context);
+bool isMethodJobRunning(int jobId);
+void runMethodJobs();
+
+#endif /* METHOD_JOBS_H */
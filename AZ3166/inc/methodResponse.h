@@ -0,0 +1,18 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef METHOD_RESPONSE_H
+#define METHOD_RESPONSE_H
+
+#include "iotHubClient.h"
+
+// handlers write their response into one fixed arena, it is reset for every call and
+// never outlives it, so a handler response can neither leak nor overrun
+#define METHOD_RESPONSE_MAX 1024
+
+int methodResponseInvoke(methodCallback callback, JsonObject& payload);
+const char *methodResponseText();
+void methodResponseSet(const char *text);
+void methodResponseToSdk(const char *text, unsigned char **response, int *responseSize);
+
+#endif /* METHOD_RESPONSE_H */
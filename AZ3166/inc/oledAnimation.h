@@ -1,12 +1,23 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. 
 
-#ifndef OLED_ANIMATION
+#ifndef OLED_ANIMATION_H
 #define OLED_ANIMATION_H
 
-void animationInit(const char **frames, int maxFrames, int width, int moveLimit, int frameDelay, bool center);
+// frames are 8 x 8 cells of 8 columns, stored as the OLED pages they are drawn with,
+// a row of cells is 72 columns including the padding around the cells
+#define ANIMATION_FRAME_WIDTH 64
+#define ANIMATION_FRAME_BYTES ((ANIMATION_FRAME_WIDTH + 8) * 8)
+
+#define ANIMATION_MAX_FRAMES 16
+
+// animations are drawn one frame per tick by animationTask, a new start replaces
+// whatever animation is showing, start and cancel can be called from any thread
+bool animationStart(const unsigned char **frames, int frameCount, int totalFrames, int moveLimit, unsigned long frameInterval, bool center);
+void animationCancel();
+bool animationRunning();
+void animationTask();
+
 void clearScreen();
-void renderNextFrame();
-void animationEnd();
 
-#endif /* OLED_ANIMATION_H */
\ No newline at end of file
+#endif /* OLED_ANIMATION_H */
@@ -0,0 +1,23 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef OUTBOUND_WORKER_H
+#define OUTBOUND_WORKER_H
+
+#define OUTBOUND_QUEUE_DEPTH 16
+#define OUTBOUND_PAYLOAD_MAX 400
+#define OUTBOUND_WORKER_STACK_SIZE 8192
+#define TELEMETRY_BATCH_DEFAULT 4
+#define TELEMETRY_BATCH_AGE_DEFAULT 30000
+
+// properties is the number of reported properties the caller put in the payload
+typedef void (*reportedCompleteCallback)(const char *payload, int properties, bool success);
+typedef void (*telemetryCompleteCallback)(int samples, bool success);
+
+bool startOutboundWorker(telemetryCompleteCallback onTelemetryComplete);
+void stopOutboundWorker();
+
+bool queueReportedProperty(const char *payload, int properties, reportedCompleteCallback onComplete);
+void setTelemetryBatching(int batchSize, unsigned long maxAge);
+
+#endif /* OUTBOUND_WORKER_H */
@@ -4,12 +4,17 @@
 #ifndef REGISTERED_METHOD_HANDLERS_H
 #define REGISTERED_METHOD_HANDLERS_H
 
-int cloudMessage(const char *payload, size_t size, char **response, size_t* resp_size); 
-int directMethod(const char *payload, size_t size, char **response, size_t* resp_size);
-int fanSpeedDesiredChange(const char *message, size_t size, char **response, size_t* resp_size);
-int voltageDesiredChange(const char *message, size_t size, char **response, size_t* resp_size);
-int currentDesiredChange(const char *message, size_t size, char **response, size_t* resp_size);
-int irOnDesiredChange(const char *message, size_t size, char **response, size_t* resp_size);
+#include <ArduinoJson.h>
+
+int cloudMessage(JsonObject& payload, char *response, size_t responseSize); 
+int directMethod(JsonObject& payload, char *response, size_t responseSize);
+int sensorStatsMethod(JsonObject& payload, char *response, size_t responseSize);
+int schedulerStatsMethod(JsonObject& payload, char *response, size_t responseSize);
+int deviceStatsMethod(JsonObject& payload, char *response, size_t responseSize);
+int fanSpeedDesiredChange(JsonObject& property, char *response, size_t responseSize);
+int voltageDesiredChange(JsonObject& property, char *response, size_t responseSize);
+int currentDesiredChange(JsonObject& property, char *response, size_t responseSize);
+int irOnDesiredChange(JsonObject& property, char *response, size_t responseSize);
 
     
 #endif /* REGISTERED_METHOD_HANDLERS_H */
\ No newline at end of file
@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef REPORTED_PROPERTIES_H
+#define REPORTED_PROPERTIES_H
+
+#define REPORTED_POOL_DEPTH 16
+#define REPORTED_NAME_MAX 64
+#define REPORTED_VALUE_MAX 200
+#define REPORTED_STATUS_MAX 32
+
+// records live in a fixed pool so echoing desired properties never touches the heap
+typedef struct TWIN_PROPERTY_REPORTED_TAG {
+    char name[REPORTED_NAME_MAX];
+    char value[REPORTED_VALUE_MAX];
+    signed int version;
+
+    char status[REPORTED_STATUS_MAX];
+    int statusCode;
+} TWIN_PROPERTY_REPORTED;
+
+void reportDesiredProperty(const char *propertyName, const char *value, int version, const char *status, int statusCode);
+void echoDesiredProperty(void);
+void setReportedPropertyWindow(unsigned long window);
+int getReportedMessagesSaved();
+int getReportedPoolHighWater();
+int getReportedPoolExhausted();
+int buildReportedStatsJson(char *buffer, int size);
+
+#endif /* REPORTED_PROPERTIES_H */
@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#define SCHEDULER_MAX_TASKS 16
+
+typedef void (*taskCallback)(void);
+typedef unsigned long (*schedulerClock)(void);
+
+typedef struct TASK_STATS_TAG {
+    const char *name;
+    unsigned long period;
+    unsigned long runs;
+    unsigned long maxJitter;
+    unsigned long maxRunTime;
+    unsigned long totalRunTime;
+    unsigned long overruns;
+} TASK_STATS;
+
+void schedulerInit(schedulerClock clock);
+int schedulerAddTask(const char *name, taskCallback callback, unsigned long period);
+void schedulerSetPeriod(int taskId, unsigned long period);
+void schedulerRun();
+
+int schedulerTaskCount();
+bool schedulerGetStats(int taskId, TASK_STATS *stats);
+void schedulerClearStats();
+int buildSchedulerStatsJson(char *buffer, int size);
+
+#endif /* SCHEDULER_H */
@@ -0,0 +1,46 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef SENSOR_SAMPLER_H
+#define SENSOR_SAMPLER_H
+
+typedef enum {
+    CHANNEL_HUMIDITY,
+    CHANNEL_TEMP,
+    CHANNEL_PRESSURE,
+    CHANNEL_MAG_X,
+    CHANNEL_MAG_Y,
+    CHANNEL_MAG_Z,
+    CHANNEL_ACCEL_X,
+    CHANNEL_ACCEL_Y,
+    CHANNEL_ACCEL_Z,
+    CHANNEL_GYRO_X,
+    CHANNEL_GYRO_Y,
+    CHANNEL_GYRO_Z,
+    CHANNEL_COUNT
+} SensorChannel;
+
+typedef struct SENSOR_CHANNEL_TAG {
+    const char *name;
+    uint8_t mask;
+    bool integer;
+} SENSOR_CHANNEL;
+
+// streaming statistics of one channel over a send window
+typedef struct CHANNEL_AGGREGATE_TAG {
+    unsigned long count;
+    float mean;
+    float m2;
+    float min;
+    float max;
+} CHANNEL_AGGREGATE;
+
+const SENSOR_CHANNEL *getSensorChannel(int channel);
+
+void sampleSensors(uint8_t sensorMask);
+void addSample(int channel, float value);
+void takeAggregates(CHANNEL_AGGREGATE *aggregates);
+void clearAggregates();
+float aggregateStdDev(const CHANNEL_AGGREGATE *aggregate);
+
+#endif /* SENSOR_SAMPLER_H */
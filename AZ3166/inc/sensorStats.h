@@ -0,0 +1,40 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef SENSOR_STATS_H
+#define SENSOR_STATS_H
+
+#define SENSOR_HISTOGRAM_BUCKETS 16
+
+typedef enum {
+    SENSOR_READ_HUMIDITY,
+    SENSOR_READ_TEMPERATURE,
+    SENSOR_READ_PRESSURE,
+    SENSOR_READ_MAGNETOMETER,
+    SENSOR_READ_ACCELEROMETER,
+    SENSOR_READ_GYROSCOPE,
+    SENSOR_READ_MOTION_FIFO,
+    SENSOR_READ_COUNT
+} SensorRead;
+
+// bucket i counts reads that took [2^i, 2^(i+1)) microseconds, the last bucket everything slower
+typedef struct SENSOR_TIMING_TAG {
+    unsigned long count;
+    unsigned long errors;
+    unsigned long totalMicros;
+    unsigned long maxMicros;
+    unsigned long histogram[SENSOR_HISTOGRAM_BUCKETS];
+} SENSOR_TIMING;
+
+void initSensorTiming();
+uint32_t sensorTimerStart();
+void sensorTimerStop(int reader, uint32_t start, bool error);
+
+const char *getSensorReadName(int reader);
+bool getSensorTiming(int reader, SENSOR_TIMING *timing);
+void clearSensorTiming();
+int buildSensorStatsJson(char *buffer, int size);
+
+void displaySensorInfo();
+
+#endif /* SENSOR_STATS_H */
@@ -9,6 +9,7 @@ void initSensors();
 // HTS221
 float readHumidity();
 float readTemperature();
+unsigned long getHumidityTemperatureTime();
 
 // LPS22HB
 float readPressure();
@@ -21,11 +22,27 @@ void readAccelerometer(int *axes);
 void readGyroscope(int *axes);
 bool checkForShake();
 
+// LSM6DSL FIFO capture
+typedef struct MOTION_SAMPLE_TAG {
+    int accel[3];
+    int gyro[3];
+} MOTION_SAMPLE;
+
+bool enableMotionFifo(int odr);
+void disableMotionFifo();
+bool isMotionFifoEnabled();
+int drainMotionFifo();
+bool takeMotionSample(MOTION_SAMPLE *sample);
+float getMotionSamplesPerSecond();
+float getMotionI2cBytesPerSample();
+
 // RGB LED
 void setLedColor(uint8_t red, uint8_t green, uint8_t blue);
 void turnLedOff();
 
 // IrDA
-void transmitIR();
+void startIRBurst();
+unsigned long irBurstDuration();
+void irBurstTask();
 
 #endif /* SENSORS_H */
\ No newline at end of file
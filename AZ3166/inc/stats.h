@@ -10,10 +10,22 @@ void incrementReportedCount();
 void incrementErrorCount();
 void incrementTelemetryCount();
 void incrementDesiredCount();
+void incrementDroppedCount();
+void addBatchSavings(int samples, int bytesSaved);
+void recordLoopTime(unsigned long elapsed);
+void incrementBackpressureCount();
+void addChannelReports(int sent, int suppressed);
 
 int getReportedCount();
 int getErrorCount();
 int getTelemetryCount();
 int getDesiredCount();
+int getDroppedCount();
+int getBytesSavedPerSample();
+unsigned long getMaxLoopTime();
+int getBackpressureCount();
+int getSuppressionPercent();
+
+int buildCounterStatsJson(char *buffer, int size);
 
 #endif /* STATS_H */
\ No newline at end of file
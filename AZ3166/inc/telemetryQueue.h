@@ -0,0 +1,38 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef TELEMETRY_QUEUE_H
+#define TELEMETRY_QUEUE_H
+
+#include "iotCentral.h"
+
+#define TELEMETRY_QUEUE_DEPTH 12
+
+typedef struct TELEMETRY_RECORD_TAG {
+    unsigned long sequence;
+    time_t timestamp;
+    unsigned long queued;
+    int length;
+    TelemetryEncoding encoding;
+    char payload[TELEMETRY_PAYLOAD_MAX];
+} TELEMETRY_RECORD;
+
+typedef struct TELEMETRY_BATCH_TAG {
+    int records;
+    int recordBytes;
+    time_t timestamp;
+    unsigned long firstSequence;
+    unsigned long lastSequence;
+    TelemetryEncoding encoding;
+} TELEMETRY_BATCH;
+
+void telemetryQueueClear();
+bool telemetryQueuePush(const char *payload, int length, time_t timestamp, TelemetryEncoding encoding);
+bool telemetryQueueCopyOldest(TELEMETRY_RECORD *record);
+void telemetryQueueRelease(unsigned long sequence);
+int telemetryQueueCount();
+unsigned long telemetryQueueOldestAge();
+
+int telemetryQueueBuildBatch(char *buffer, int size, int maxRecords, TELEMETRY_BATCH *batch);
+
+#endif /* TELEMETRY_QUEUE_H */
@@ -0,0 +1,13 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef TIMED_OUTPUT_H
+#define TIMED_OUTPUT_H
+
+#define TIMED_OUTPUT_MAX 4
+
+void pulseOutput(int pin, unsigned long duration);
+void updateTimedOutputs();
+void clearTimedOutputs();
+
+#endif /* TIMED_OUTPUT_H */
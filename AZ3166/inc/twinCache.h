@@ -0,0 +1,30 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef TWIN_CACHE_H
+#define TWIN_CACHE_H
+
+// remembers which desired properties were applied so a reboot does not repeat their side effects,
+// the version only filters partial updates, complete twins are always diffed against reported
+#define TWIN_CACHE_MAX_ENTRIES 14
+
+typedef struct TWIN_CACHE_ENTRY_TAG {
+    uint32_t nameHash;
+    uint32_t valueHash;
+} TWIN_CACHE_ENTRY;
+
+// stored as is in the twin cache EEPROM zone, must fit in TWIN_CACHE_MAX_LEN
+typedef struct TWIN_CACHE_TAG {
+    uint32_t magic;
+    int32_t version;
+    uint32_t count;
+    TWIN_CACHE_ENTRY entries[TWIN_CACHE_MAX_ENTRIES];
+} TWIN_CACHE;
+
+void twinCacheLoad();
+int twinCacheVersion();
+bool twinCacheMatches(const char *name, const char *value);
+void twinCacheUpdate(const char *name, const char *value);
+void twinCacheCommit(int version);
+
+#endif /* TWIN_CACHE_H */
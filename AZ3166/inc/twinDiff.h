@@ -0,0 +1,18 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef TWIN_DIFF_H
+#define TWIN_DIFF_H
+
+#include <ArduinoJson.h>
+
+// longest property value compared, the same bound the reported echo has
+#define TWIN_DIFF_VALUE_MAX 200
+
+// called for every desired property whose value is not yet reflected in the reported properties
+typedef void (*twinChangeCallback)(const char *name, JsonObject& property, int version);
+
+int twinDiff(JsonObject& desired, JsonObject& reported, twinChangeCallback onChange);
+bool twinValueText(JsonObject& property, char *buffer, size_t size);
+
+#endif /* TWIN_DIFF_H */
@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef TWIN_INDEX_H
+#define TWIN_INDEX_H
+
+// the reported properties of a twin sorted by name hash, so each desired property is
+// looked up in O(log n) instead of being compared with every reported name
+typedef struct TWIN_INDEX_ENTRY_TAG {
+    uint32_t nameHash;
+    uint32_t valueHash;
+    const char *name;
+} TWIN_INDEX_ENTRY;
+
+// names are not copied, they have to outlive the index
+typedef struct TWIN_INDEX_TAG {
+    TWIN_INDEX_ENTRY *entries;
+    int size;
+    int count;
+} TWIN_INDEX;
+
+bool twinIndexInit(TWIN_INDEX *index, int size);
+bool twinIndexAdd(TWIN_INDEX *index, const char *name, const char *value);
+void twinIndexSort(TWIN_INDEX *index);
+bool twinIndexMatches(const TWIN_INDEX *index, const char *name, const char *value);
+void twinIndexFree(TWIN_INDEX *index);
+
+#endif /* TWIN_INDEX_H */
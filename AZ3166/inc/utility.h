@@ -4,9 +4,11 @@
 #ifndef UTILITY_H
 #define UTILITY_H
 
+char *dtostrf(double number, signed char width, unsigned char prec, char *s);
 char *f2s(float f, int p);
 String urldecode(String str);
 bool SyncTimeToNTP();
 int _stricmp(const char *a, const char *b);
+uint32_t hashText(const char *text, bool ignoreCase);
 
 #endif /* UTILITY_H */
\ No newline at end of file
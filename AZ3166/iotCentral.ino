@@ -37,6 +37,7 @@ Uses the following libraries:
 #include "inc/main_telemetry.h"
 #include "inc/config.h"
 #include "inc/device.h"
+#include "inc/displayCache.h"
 
 bool configured = false;
 String iotCentralConfig;
@@ -68,8 +69,10 @@ void loop()
 {
     // reset the device if the A and B buttons are both pressed and held
     if (IsButtonClicked(USER_BUTTON_A) && IsButtonClicked(USER_BUTTON_B)) {
+        displayLock();
         Screen.clean();
         Screen.print(0, "Device resetting");
+        displayUnlock();
         clearAllConfig();
         
         if (configured) {
@@ -80,10 +83,12 @@ void loop()
 
         configured = false;
         delay(1000);  //artificial pause
+        displayLock();
         Screen.clean();
         Screen.print(0, "Device is reset");
         Screen.print(1, "Press reset");
         Screen.print(2, "to configure");
+        displayUnlock();
     }
 
 	if (configured) {
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/callbackTable.h"
+#include "../inc/utility.h"
+
+// the size is always a power of two, returns true if the entry missed its home slot
+static bool placeEntry(CALLBACK_TABLE *table, const CALLBACK_ENTRY *entry) {
+    int slot = entry->hash & (table->size - 1);
+    bool collided = false;
+
+    while (table->entries[slot].callback != NULL) {
+        collided = true;
+        slot = (slot + 1) & (table->size - 1);
+    }
+
+    table->entries[slot] = *entry;
+    if (collided) {
+        table->collisions++;
+    }
+    return collided;
+}
+
+static bool growTable(CALLBACK_TABLE *table) {
+    int size = (table->size == 0) ? CALLBACK_TABLE_MIN_SIZE : table->size * 2;
+    CALLBACK_ENTRY *entries = (CALLBACK_ENTRY *)calloc(size, sizeof(CALLBACK_ENTRY));
+    if (entries == NULL) {
+        return false;
+    }
+
+    CALLBACK_ENTRY *oldEntries = table->entries;
+    int oldSize = table->size;
+    table->entries = entries;
+    table->size = size;
+    table->collisions = 0;
+    for (int i = 0; i < oldSize; i++) {
+        if (oldEntries[i].callback != NULL) {
+            placeEntry(table, &oldEntries[i]);
+        }
+    }
+    free(oldEntries);
+
+    return true;
+}
+
+bool callbackTableAdd(CALLBACK_TABLE *table, const char *name, methodCallback callback) {
+    if (name == NULL || callback == NULL) {
+        return false;
+    }
+
+    // the first registration of a name wins, as with the old linear lookup
+    if (callbackTableFind(table, name) != NULL) {
+        return false;
+    }
+
+    if ((table->count + 1) * 2 > table->size && !growTable(table)) {
+        Serial.printf("Callback %s not registered, out of memory\r\n", name);
+        return false;
+    }
+
+    CALLBACK_ENTRY entry;
+    entry.hash = hashText(name, true);
+    entry.name = strdup(name);
+    entry.callback = callback;
+    if (entry.name == NULL) {
+        return false;
+    }
+
+    if (placeEntry(table, &entry)) {
+        Serial.printf("Callback %s collides with another name in the dispatch table\r\n", name);
+    }
+    table->count++;
+    return true;
+}
+
+methodCallback callbackTableFind(CALLBACK_TABLE *table, const char *name) {
+    if (name == NULL || table->size == 0) {
+        return NULL;
+    }
+
+    uint32_t hash = hashText(name, true);
+    int slot = hash & (table->size - 1);
+    while (table->entries[slot].callback != NULL) {
+        if (table->entries[slot].hash == hash && _stricmp(table->entries[slot].name, name) == 0) {
+            return table->entries[slot].callback;
+        }
+        slot = (slot + 1) & (table->size - 1);
+    }
+
+    return NULL;
+}
+
+int callbackTableCollisions(CALLBACK_TABLE *table) {
+    return table->collisions;
+}
@@ -0,0 +1,138 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/cborWriter.h"
+
+#define CBOR_UNSIGNED 0x00
+#define CBOR_NEGATIVE 0x20
+#define CBOR_TEXT 0x60
+#define CBOR_ARRAY 0x80
+#define CBOR_MAP 0xA0
+#define CBOR_FLOAT32 0xFA
+#define CBOR_INDEFINITE 0x1F
+#define CBOR_BREAK 0xFF
+
+static void appendByte(CBOR_WRITER *writer, uint8_t value) {
+    if (writer->overflow || writer->length >= writer->size) {
+        writer->overflow = true;
+        return;
+    }
+    writer->buffer[writer->length++] = value;
+}
+
+// major type and argument, always in the shortest form. Maps and arrays are indefinite
+// length, so the output is valid CBOR but not canonical (RFC 7049 section 3.9)
+static void appendHead(CBOR_WRITER *writer, uint8_t major, uint32_t value) {
+    if (value < 24) {
+        appendByte(writer, major | value);
+    } else if (value <= 0xFF) {
+        appendByte(writer, major | 24);
+        appendByte(writer, value);
+    } else if (value <= 0xFFFF) {
+        appendByte(writer, major | 25);
+        appendByte(writer, value >> 8);
+        appendByte(writer, value);
+    } else {
+        appendByte(writer, major | 26);
+        appendByte(writer, value >> 24);
+        appendByte(writer, value >> 16);
+        appendByte(writer, value >> 8);
+        appendByte(writer, value);
+    }
+}
+
+static void appendText(CBOR_WRITER *writer, const char *text) {
+    int length = strlen(text);
+    appendHead(writer, CBOR_TEXT, length);
+    for (int i = 0; i < length; i++) {
+        appendByte(writer, text[i]);
+    }
+}
+
+static void beginValue(CBOR_WRITER *writer, const char *key) {
+    if (key != NULL) {
+        appendText(writer, key);
+    }
+}
+
+void cborWriterInit(CBOR_WRITER *writer, uint8_t *buffer, int size) {
+    writer->buffer = buffer;
+    writer->size = size;
+    writer->length = 0;
+    writer->overflow = (size < 1);
+}
+
+void cborWriterBeginMap(CBOR_WRITER *writer, const char *key) {
+    beginValue(writer, key);
+    appendByte(writer, CBOR_MAP | CBOR_INDEFINITE);
+}
+
+void cborWriterEndMap(CBOR_WRITER *writer) {
+    appendByte(writer, CBOR_BREAK);
+}
+
+void cborWriterBeginArray(CBOR_WRITER *writer, const char *key) {
+    beginValue(writer, key);
+    appendByte(writer, CBOR_ARRAY | CBOR_INDEFINITE);
+}
+
+void cborWriterEndArray(CBOR_WRITER *writer) {
+    appendByte(writer, CBOR_BREAK);
+}
+
+void cborWriterAddInt(CBOR_WRITER *writer, const char *key, int value) {
+    beginValue(writer, key);
+    if (value >= 0) {
+        appendHead(writer, CBOR_UNSIGNED, value);
+    } else {
+        appendHead(writer, CBOR_NEGATIVE, (uint32_t)(-1 - value));
+    }
+}
+
+void cborWriterAddFloat(CBOR_WRITER *writer, const char *key, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    beginValue(writer, key);
+    appendByte(writer, CBOR_FLOAT32);
+    appendByte(writer, bits >> 24);
+    appendByte(writer, bits >> 16);
+    appendByte(writer, bits >> 8);
+    appendByte(writer, bits);
+}
+
+void cborWriterAddString(CBOR_WRITER *writer, const char *key, const char *value) {
+    beginValue(writer, key);
+    appendText(writer, value);
+}
+
+// merges the members of an already encoded indefinite length map into the current map
+void cborWriterAddMembers(CBOR_WRITER *writer, const uint8_t *map, int length) {
+    if (length < 2 || map[0] != (CBOR_MAP | CBOR_INDEFINITE) || map[length - 1] != CBOR_BREAK) {
+        writer->overflow = true;
+        return;
+    }
+
+    for (int i = 1; i < length - 1; i++) {
+        appendByte(writer, map[i]);
+    }
+}
+
+int cborWriterLength(CBOR_WRITER *writer) {
+    return writer->length;
+}
+
+// rolls the output back to an earlier length, e.g. to drop a value that did not fit
+void cborWriterTruncate(CBOR_WRITER *writer, int length) {
+    if (length < 0 || length > writer->length) {
+        return;
+    }
+    writer->length = length;
+    writer->overflow = false;
+}
+
+bool cborWriterOverflow(CBOR_WRITER *writer) {
+    return writer->overflow;
+}
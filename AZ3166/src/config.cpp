@@ -11,6 +11,7 @@ void clearAllConfig() {
     clearWiFiEEPROM();
     clearAzureEEPROM();
     clearIotCentralEEPROM();
+    clearTwinCacheEEPROM();
 }
 
 void storeWiFi(const char *ssid, const char *password) {
@@ -30,6 +31,11 @@ void storeIotCentralConfig(const char *iotCentralConfig, int size) {
     eeprom.write((uint8_t*)iotCentralConfig, size, IOT_CENTRAL_ZONE_IDX);
 }
 
+void storeTwinCache(const uint8_t *twinCache, int size) {
+    EEPROMInterface eeprom;
+    eeprom.write((uint8_t*)twinCache, min(size, TWIN_CACHE_MAX_LEN), TWIN_CACHE_ZONE_IDX);
+}
+
 void readWiFi(char* ssid, int ssidLen, char *password, int passwordLen) {
     EEPROMInterface eeprom;
     eeprom.read((uint8_t*)ssid, ssidLen, 0, WIFI_SSID_ZONE_IDX);
@@ -50,6 +56,11 @@ String readIotCentralConfig() {
     return String((const char*)iotCentralConfig);
 }
 
+void readTwinCache(uint8_t *twinCache, int size) {
+    EEPROMInterface eeprom;
+    eeprom.read(twinCache, min(size, TWIN_CACHE_MAX_LEN), 0, TWIN_CACHE_ZONE_IDX);
+}
+
 void clearWiFiEEPROM() {
     EEPROMInterface eeprom;
     
@@ -76,4 +87,12 @@ void clearIotCentralEEPROM() {
     uint8_t *cleanBuff = (uint8_t*) calloc(IOT_CENTRAL_MAX_LEN, 1);
     eeprom.write(cleanBuff, IOT_CENTRAL_MAX_LEN, IOT_CENTRAL_ZONE_IDX);
     free(cleanBuff);
+}
+
+void clearTwinCacheEEPROM() {
+    EEPROMInterface eeprom;
+    
+    uint8_t *cleanBuff = (uint8_t*) calloc(TWIN_CACHE_MAX_LEN, 1);
+    eeprom.write(cleanBuff, TWIN_CACHE_MAX_LEN, TWIN_CACHE_ZONE_IDX);
+    free(cleanBuff);
 }
\ No newline at end of file
@@ -0,0 +1,66 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/deadband.h"
+#include "../inc/sensorSampler.h"
+
+// a channel is only sent when it moved more than its threshold since it was last sent,
+// or when it has been silent for the heartbeat
+typedef struct DEADBAND_STATE_TAG {
+    float threshold;
+    bool sent;
+    float lastValue;
+    unsigned long lastSent;
+} DEADBAND_STATE;
+
+static DEADBAND_STATE channels[CHANNEL_COUNT];
+static unsigned long heartbeatPeriod = DEADBAND_HEARTBEAT_DEFAULT;
+
+static int sensorIndex(uint8_t mask) {
+    for (int i = 0; i < DEADBAND_SENSOR_COUNT; i++) {
+        if (mask == (0x80 >> i)) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// thresholds are in tenths for float channels and whole units for integer channels,
+// a threshold of 0 sends the channel every time
+void deadbandConfigure(const uint8_t *sensorThresholds, unsigned long heartbeat) {
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        const SENSOR_CHANNEL *channel = getSensorChannel(i);
+        int sensor = sensorIndex(channel->mask);
+        channels[i].threshold = 0;
+        if (sensor >= 0) {
+            channels[i].threshold = sensorThresholds[sensor] * (channel->integer ? 1.0f : 0.1f);
+        }
+    }
+    heartbeatPeriod = (heartbeat > 0) ? heartbeat : DEADBAND_HEARTBEAT_DEFAULT;
+    deadbandClear();
+}
+
+void deadbandClear() {
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        channels[i].sent = false;
+    }
+}
+
+// returns true and remembers the value when the channel should be sent
+bool deadbandCheck(int channel, float value, unsigned long now) {
+    DEADBAND_STATE *state = &channels[channel];
+
+    bool send = !state->sent ||
+        state->threshold <= 0 ||
+        fabsf(value - state->lastValue) > state->threshold ||
+        now - state->lastSent >= heartbeatPeriod;
+
+    if (send) {
+        state->sent = true;
+        state->lastValue = value;
+        state->lastSent = now;
+    }
+    return send;
+}
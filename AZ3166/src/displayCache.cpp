@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+
+#include "../inc/displayCache.h"
+
+// the text last sent for every line of the OLED, only lines that differ are sent again and
+// only as far as the longer of the new and the old text reaches
+static char lines[DISPLAY_LINES][DISPLAY_LINE_CHARS + 1];
+static int shown[DISPLAY_LINES];
+static volatile bool invalid = true;
+
+static unsigned long bytesWritten = 0;
+static unsigned long bytesSaved = 0;
+static unsigned long statsStart = 0;
+
+// a message stays up until this time, the info pages wait for it
+static unsigned long heldUntil = 0;
+static volatile bool held = false;
+
+// held around every use of the panel so a frame, a message and a page never interleave
+static Mutex screenLock;
+
+void displayLock() {
+    screenLock.lock();
+}
+
+void displayUnlock() {
+    screenLock.unlock();
+}
+
+// bytes sent to the panel by a print of text, as the driver draws it character by character
+static unsigned long printBytes(int line, const char *text, bool wrap) {
+    unsigned long length = strlen(text);
+    unsigned long room = (wrap ? DISPLAY_LINES - line : 1) * DISPLAY_LINE_CHARS;
+    return ((length < room) ? length : room) * DISPLAY_CHAR_BYTES;
+}
+
+// clears the panel so it matches a cache of blank lines
+static void resetScreen() {
+    Screen.clean();
+    bytesWritten += DISPLAY_CLEAN_BYTES;
+    for (int i = 0; i < DISPLAY_LINES; i++) {
+        memset(lines[i], ' ', DISPLAY_LINE_CHARS);
+        lines[i][DISPLAY_LINE_CHARS] = 0;
+        shown[i] = 0;
+    }
+}
+
+// prints text starting at the given line, '\n' moves on to the next line and each line is
+// cut to the display width with the rest of it blank, same as Screen.print without wrapping
+void displayPrint(int line, const char *text) {
+    screenLock.lock();
+    if (invalid) {
+        invalid = false;
+        resetScreen();
+    }
+
+    while (line < DISPLAY_LINES) {
+        char next[DISPLAY_LINE_CHARS + 1];
+        int length = 0;
+
+        while (*text != 0 && *text != '\n') {
+            if (*text != '\r' && length < DISPLAY_LINE_CHARS) {
+                next[length++] = *text;
+            }
+            text++;
+        }
+        memset(next + length, ' ', DISPLAY_LINE_CHARS - length);
+        next[DISPLAY_LINE_CHARS] = 0;
+
+        // savings are counted against printing the full line width every time
+        int send = 0;
+        if (strcmp(next, lines[line]) != 0) {
+            send = (length > shown[line]) ? length : shown[line];
+            strcpy(lines[line], next);
+            shown[line] = length;
+            next[send] = 0;
+            Screen.print(line, next);
+            bytesWritten += send * DISPLAY_CHAR_BYTES;
+        }
+        bytesSaved += (DISPLAY_LINE_CHARS - send) * DISPLAY_CHAR_BYTES;
+
+        if (*text == 0) {
+            break;
+        }
+        text++;
+        line++;
+    }
+    screenLock.unlock();
+}
+
+// something else drew on the panel, the next print clears it and redraws every line
+void displayInvalidate() {
+    invalid = true;
+}
+
+// shows a title and wrapped text in place of the info pages for holdTime milliseconds
+void displayMessage(const char *title, const char *text, unsigned long holdTime) {
+    screenLock.lock();
+    Screen.clean();
+    Screen.print(0, title);
+    bytesWritten += DISPLAY_CLEAN_BYTES + printBytes(0, title, false);
+    if (text != NULL) {
+        Screen.print(1, text, true);
+        bytesWritten += printBytes(1, text, true);
+    }
+    invalid = true;
+    heldUntil = millis() + holdTime;
+    held = true;
+    screenLock.unlock();
+}
+
+bool displayHeld() {
+    if (held && (long)(millis() - heldUntil) >= 0) {
+        held = false;
+    }
+    return held;
+}
+
+void clearDisplayStats() {
+    bytesWritten = 0;
+    bytesSaved = 0;
+    statsStart = millis();
+}
+
+unsigned long getDisplayBytesWritten() {
+    return bytesWritten;
+}
+
+unsigned long getDisplayBytesSavedPerSecond() {
+    unsigned long elapsed = millis() - statsStart;
+    if (elapsed < 1000) {
+        return 0;
+    }
+    return bytesSaved / (elapsed / 1000);
+}
@@ -1,13 +1,39 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. 
 #include "Arduino.h"
+#include "mbed.h"
 #include "AudioClassV2.h"
 
 #include "../inc/fanSound.h"
 #include "../inc/fanSoundData.h"
 
+// startPlay only returns once the whole clip was played, so it runs on its own low
+// priority thread and the caller goes straight on
+#define FAN_SOUND_STACK_SIZE 2048
+
+static Thread *soundThread = NULL;
+static Semaphore soundRequested(0);
+static volatile bool soundPlaying = false;
+
+static void soundLoop() {
+    while (true) {
+        soundRequested.wait(osWaitForever);
+        AudioClass& audio = AudioClass::getInstance();
+        audio.startPlay((char*)fanSoundData, FAN_SOUND_DATA_SIZE);
+        soundPlaying = false;
+    }
+}
+
+// a request while the clip is still playing is ignored
 void playFanSound(void)
 {
-    AudioClass& audio = AudioClass::getInstance();
-    audio.startPlay((char*)fanSoundData, FAN_SOUND_DATA_SIZE);
+    if (soundThread == NULL) {
+        soundThread = new Thread(osPriorityLow, FAN_SOUND_STACK_SIZE);
+        soundThread->start(soundLoop);
+    }
+
+    if (!soundPlaying) {
+        soundPlaying = true;
+        soundRequested.release();
+    }
 }
@@ -0,0 +1,35 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/inboundMessage.h"
+
+// one message is handled at a time, the SDK callback copies and waits until the main thread is done
+static char inboundBuffer[INBOUND_MESSAGE_MAX];
+static int inboundLength = 0;
+
+// a missing payload is an empty message, one that does not fit is dropped and the buffer kept
+bool inboundMessageCopy(const char *text, int length) {
+    if (text == NULL || length < 0) {
+        length = 0;
+    }
+    if (length >= INBOUND_MESSAGE_MAX) {
+        Serial.printf("Inbound message of %d bytes dropped, limit is %d\r\n", length, INBOUND_MESSAGE_MAX - 1);
+        return false;
+    }
+    if (length > 0) {
+        memcpy(inboundBuffer, text, length);
+    }
+    inboundBuffer[length] = 0;
+    inboundLength = length;
+    return true;
+}
+
+char *inboundMessageText() {
+    return inboundBuffer;
+}
+
+int inboundMessageLength() {
+    return inboundLength;
+}
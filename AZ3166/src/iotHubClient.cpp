@@ -4,6 +4,7 @@
 #include "Arduino.h"
 #include "AzureIotHub.h"
 #include "DevKitMQTTClient.h"
+#include "SystemVersion.h"
 
 #include <ArduinoJson.h>
 
@@ -13,8 +14,14 @@
 #include "../inc/stats.h"
 #include "../inc/utility.h"
 #include "../inc/wifi.h"
-
-#define MAX_CALLBACK_COUNT 32
+#include "../inc/outboundWorker.h"
+#include "../inc/callbackTable.h"
+#include "../inc/twinDiff.h"
+#include "../inc/twinCache.h"
+#include "../inc/displayCache.h"
+#include "../inc/inboundMessage.h"
+#include "../inc/reportedProperties.h"
+#include "../inc/methodResponse.h"
 
 // forward declarations
 static void receiveMessageCallback(const char *text, int length);
@@ -22,28 +29,36 @@ static void deviceTwinGetStateCallback(DEVICE_TWIN_UPDATE_STATE updateState, con
 static int deviceDirectMethodCallback(const char *methodName, const unsigned char *payLoad, int size, unsigned char **response, int *response_size);
 static void deviceTwinConfirmationCallback(int status_code);
 
-typedef struct TWIN_PROPERTY_REPORTED_TAG {
-    char* name;
-    char* value;
-    signed int version;
-
-    char* status;
-    int statusCode;
-} TWIN_PROPERTY_REPORTED;
-
-typedef struct CALLBACK_LOOKUP_TAG {
-    char* name;
-    methodCallback callback;
-} CALLBACK_LOOKUP;
-
-static CALLBACK_LOOKUP methodCallbackList[MAX_CALLBACK_COUNT];
-static int methodCallbackCount = 0;
-static CALLBACK_LOOKUP desiredCallbackList[MAX_CALLBACK_COUNT];
-static int desiredCallbackCount = 0;
+static CALLBACK_TABLE methodCallbacks;
+static CALLBACK_TABLE desiredCallbacks;
 static String deviceId;
 static String hubName;
 
-Queue<TWIN_PROPERTY_REPORTED, 16> queuePropertyReported;
+// $version of the last desired properties acted upon, restored from the twin cache at start up
+static int lastDesiredVersion = 0;
+
+// the SDK calls back from inside its sends on the outbound worker thread, each callback
+// hands its request to the main thread and waits, so handlers never race the scheduler tasks
+typedef enum {
+    INBOUND_MESSAGE,
+    INBOUND_METHOD,
+    INBOUND_TWIN
+} InboundType;
+
+typedef struct INBOUND_REQUEST_TAG {
+    InboundType type;
+    const char *methodName;
+    DEVICE_TWIN_UPDATE_STATE updateState;
+    char *twin;
+    int status;
+    bool handled;
+} INBOUND_REQUEST;
+
+static osThreadId mainThreadId = NULL;
+static Mutex inboundLock;
+static Semaphore inboundDone(0);
+static INBOUND_REQUEST *inboundRequest = NULL;
+static bool inboundOpen = false;
 
 void initIotHubClient(bool traceOn) {
     String connString = readConnectionString();
@@ -51,6 +66,15 @@ void initIotHubClient(bool traceOn) {
     hubName = connString.substring(connString.indexOf("HostName=") + 9, connString.indexOf(";DeviceId="));
     hubName = hubName.substring(0, hubName.indexOf("."));
 
+    twinCacheLoad();
+    lastDesiredVersion = twinCacheVersion();
+
+    // callbacks made on this thread are handled inline, see dispatchInbound
+    mainThreadId = osThreadGetId();
+    inboundLock.lock();
+    inboundOpen = true;
+    inboundLock.unlock();
+
     DevKitMQTTClient_Init(true, traceOn);
 
     // Setting Message call back, so we can receive Commands.
@@ -66,12 +90,53 @@ void initIotHubClient(bool traceOn) {
     DevKitMQTTClient_SetReportConfirmationCallback(deviceTwinConfirmationCallback);
 }
 
-bool sendTelemetry(const char *payload) {
-    EVENT_INSTANCE* message = DevKitMQTTClient_Event_Generate(payload, MESSAGE);
+// the DevKit client only builds events from strings, so a binary payload replaces the
+// message handle of an empty event. That relies on the EVENT_INSTANCE layout and on
+// DevKitMQTTClient_SendEventInstance destroying the handle it finds there, as the 1.x
+// DevKit SDK does, other versions send JSON instead
+static const char *binaryEventSdkVersion = "1.";
+
+bool binaryEventsSupported() {
+    return strncmp(getDevkitVersion(), binaryEventSdkVersion, strlen(binaryEventSdkVersion)) == 0;
+}
+
+static EVENT_INSTANCE *generateBinaryEvent(const unsigned char *payload, int length) {
+    if (!binaryEventsSupported()) {
+        return NULL;
+    }
+
+    IOTHUB_MESSAGE_HANDLE messageHandle = IoTHubMessage_CreateFromByteArray(payload, length);
+    if (messageHandle == NULL) {
+        return NULL;
+    }
+
+    EVENT_INSTANCE *message = DevKitMQTTClient_Event_Generate("", MESSAGE);
+    if (message == NULL) {
+        IoTHubMessage_Destroy(messageHandle);
+        return NULL;
+    }
+    IoTHubMessage_Destroy(message->messageHandle);
+    message->messageHandle = messageHandle;
+    return message;
+}
+
+bool sendTelemetry(const char *payload, int length, time_t timestamp, TelemetryEncoding encoding) {
+    EVENT_INSTANCE* message;
 
-    // add a timestamp to the message - illustrated for the use in batching
-    time_t seconds = time(NULL);
-    char *temp = ctime(&seconds);
+    if (encoding == TELEMETRY_CBOR) {
+        message = generateBinaryEvent((const unsigned char*)payload, length);
+        if (message == NULL) {
+            return false;
+        }
+        IoTHubMessage_SetContentTypeSystemProperty(message->messageHandle, "application/cbor");
+    } else {
+        message = DevKitMQTTClient_Event_Generate(payload, MESSAGE);
+        IoTHubMessage_SetContentTypeSystemProperty(message->messageHandle, "application/json");
+        IoTHubMessage_SetContentEncodingSystemProperty(message->messageHandle, "utf-8");
+    }
+
+    // add the time the reading was taken to the message - illustrated for the use in batching
+    char *temp = ctime(&timestamp);
     temp[strlen(temp) - 1] = 0;   // There is a new line character ('\n') at the end of the string which will disturb the json string, so remove it
     DevKitMQTTClient_Event_AddProp(message, "timestamp", temp);
     return DevKitMQTTClient_SendEventInstance(message);
@@ -82,28 +147,24 @@ bool sendReportedProperty(const char *payload) {
     return DevKitMQTTClient_SendEventInstance(message);
 }
 
+// the SDK only delivers commands and twin updates while it does work for an event, so a
+// device with nothing to send lets it work here, called from the thread that sends
+void checkIotHubClient() {
+    DevKitMQTTClient_Check(false);
+}
+
 // register callbacks for direct and cloud to device messages
 bool registerMethod(const char *methodName, methodCallback callback) {
-    if (methodCallbackCount < MAX_CALLBACK_COUNT) {
-        methodCallbackList[methodCallbackCount].name = strdup(methodName);
-        methodCallbackList[methodCallbackCount].callback = callback;
-        methodCallbackCount++;
-        return true;
-    } else {
-        return false;
-    }
+    return callbackTableAdd(&methodCallbacks, methodName, callback);
 }
 
 // register callbacks for desired properties
 bool registerDesiredProperty(const char *propertyName, methodCallback callback) {
-    if (desiredCallbackCount < MAX_CALLBACK_COUNT) {
-        desiredCallbackList[desiredCallbackCount].name = strdup(propertyName);
-        desiredCallbackList[desiredCallbackCount].callback = callback;
-        desiredCallbackCount++;
-        return true;
-    } else {
-        return false;
-    }
+    return callbackTableAdd(&desiredCallbacks, propertyName, callback);
+}
+
+int getCallbackCollisions() {
+    return callbackTableCollisions(&methodCallbacks) + callbackTableCollisions(&desiredCallbacks);
 }
 
 void closeIotHubClient(void)
@@ -111,15 +172,92 @@ void closeIotHubClient(void)
     DevKitMQTTClient_Close();
 }
 
+// the C2D payload is either a nested object or a JSON document sent as a string,
+// the string already sits unescaped in the inbound buffer so it is parsed in place as well
+static JsonObject& payloadObject(JsonBuffer& jsonBuffer, JsonVariant payload) {
+    if (payload.is<JsonObject>()) {
+        return payload.as<JsonObject>();
+    }
+    if (payload.is<const char*>()) {
+        return jsonBuffer.parseObject(const_cast<char*>(payload.as<const char*>()));
+    }
+    return JsonObject::invalid();
+}
+
+// an object that does not parse is broken or has more members than fit the arena, other
+// payloads (none, null or a plain value) are handed on as an invalid object as before
+static bool startsObject(const char *text) {
+    while (*text == ' ' || *text == '\t' || *text == '\r' || *text == '\n') {
+        text++;
+    }
+    return *text == '{';
+}
+
+static void runInbound(INBOUND_REQUEST *request);
+
+// runs the request on the main thread, the calling SDK thread waits until it is done,
+// returns false if the client is closing and the request was not run
+static bool dispatchInbound(INBOUND_REQUEST *request) {
+    request->handled = false;
+    if (osThreadGetId() == mainThreadId) {
+        runInbound(request);
+        return true;
+    }
+
+    inboundLock.lock();
+    if (!inboundOpen) {
+        inboundLock.unlock();
+        return false;
+    }
+    inboundRequest = request;
+    inboundLock.unlock();
+
+    inboundDone.wait(osWaitForever);
+    return request->handled;
+}
+
+// scheduler task on the main thread, runs the request an SDK callback is waiting on
+void processInbound(void) {
+    inboundLock.lock();
+    INBOUND_REQUEST *request = inboundRequest;
+    inboundLock.unlock();
+    if (request == NULL) {
+        return;
+    }
+
+    runInbound(request);
+
+    inboundLock.lock();
+    inboundRequest = NULL;
+    inboundLock.unlock();
+    inboundDone.release();
+}
+
+// called before the outbound worker is stopped so a callback waiting on the main thread
+// can return, it is answered as not handled
+void closeInbound(void) {
+    inboundLock.lock();
+    inboundOpen = false;
+    if (inboundRequest != NULL) {
+        inboundRequest = NULL;
+        inboundDone.release();
+    }
+    inboundLock.unlock();
+}
+
 static void receiveMessageCallback(const char *text, int length)
 {
-    if (text == NULL || length < 1)
+    if (text == NULL || length < 1 || !inboundMessageCopy(text, length))
     {
         return;
     }
-    char *buffer = (char *)calloc(length + 1, 1);
-    memcpy(buffer, text, length);
 
+    INBOUND_REQUEST request;
+    request.type = INBOUND_MESSAGE;
+    dispatchInbound(&request);
+}
+
+static void processMessage() {
     // message format expected:
     // {
     //     "methodName" : "<method name>",
@@ -129,25 +267,51 @@ static void receiveMessageCallback(const char *text, int length)
     //         ...
     //     }
     // }
-    DynamicJsonBuffer jsonBuffer;
-    JsonObject& root = jsonBuffer.parseObject(buffer);
+    int length = inboundMessageLength();
+    StaticJsonBuffer<INBOUND_JSON_ARENA> jsonBuffer;
+    JsonObject& root = jsonBuffer.parseObject(inboundMessageText());
+    if (!root.success()) {
+        Serial.printf("C2D message of %d bytes dropped, not a JSON object or too many members\r\n", length);
+        return;
+    }
     const char *methodName = root["methodName"];
-    int status = 0;
-    char *methodResponse;
     
-    // lookup if the method has been registered to a function
-    for(int i = 0; i < methodCallbackCount; i++) {
-        if (_stricmp(methodName, methodCallbackList[i].name) == 0) {
-            const char* params = root["payload"];
-            status = methodCallbackList[i].callback(params, strlen(params), &methodResponse, NULL);
-            break;
+    // lookup if the method has been registered to a function, C2D messages have no response
+    methodCallback callback = callbackTableFind(&methodCallbacks, methodName);
+    if (callback != NULL) {
+        JsonVariant payload = root["payload"];
+        bool objectSent = payload.is<JsonObject>() || (payload.is<const char*>() && startsObject(payload.as<const char*>()));
+        JsonObject& params = payloadObject(jsonBuffer, payload);
+        if (objectSent && !params.success()) {
+            Serial.printf("C2D message %s dropped, payload is not a JSON object or has too many members\r\n", methodName);
+            return;
         }
+        methodResponseInvoke(callback, params);
     }
-    free(buffer);
 }
 
 static int deviceDirectMethodCallback(const char *methodName, const unsigned char *payLoad, int size, unsigned char **response, int *response_size)
 {
+    if (!inboundMessageCopy((const char*)payLoad, size)) {
+        methodResponseToSdk("{\"status\":\"payload too large\"}", response, response_size);
+        return 413;
+    }
+
+    INBOUND_REQUEST request;
+    request.type = INBOUND_METHOD;
+    request.methodName = methodName;
+    if (!dispatchInbound(&request)) {
+        methodResponseToSdk("{\"status\":\"device closing\"}", response, response_size);
+        return 503;
+    }
+
+    methodResponseToSdk(methodResponseText(), response, response_size);
+    Serial.printf("Device Method %s called\r\n", methodName);
+
+    return request.status;
+}
+
+static int processMethod(const char *methodName) {
     // message format expected:
     // {
     //     "methodName": "reboot",
@@ -159,90 +323,59 @@ static int deviceDirectMethodCallback(const char *methodName, const unsigned cha
     //     }
     // }
 
-    int status = 0;
-    char* methodResponse;
-    
-    char *buffer = (char *)calloc(size + 1, 1);
-    memcpy(buffer, payLoad, size);
-
     // lookup if the method has been registered to a function
-    for(int i = 0; i < methodCallbackCount; i++) {
-        if (_stricmp(methodName, methodCallbackList[i].name) == 0) {
-            status = methodCallbackList[i].callback((const char*)buffer, size + 1, &methodResponse, NULL);
-            break;
-        }
+    methodCallback callback = callbackTableFind(&methodCallbacks, methodName);
+    if (callback == NULL) {
+        methodResponseSet("{\"status\":\"method not found\"}");
+        return 404;
     }
 
-    Serial.printf("Device Method %s called\r\n", methodName);
-    free(buffer);
-
-    return status;
-}
-
-// every desired property change gets echoed back as a reported property
-void echoDesiredProperty(void) {
-    while (true) {
-        osEvent evt = queuePropertyReported.get(1);
-        if (evt.status == osEventMessage) {
-            char buff[400];
-            TWIN_PROPERTY_REPORTED *propertyReported = (TWIN_PROPERTY_REPORTED*)evt.value.p;
-
-            sprintf(buff, "{\"%s\":{\"value\":%s, \"statusCode\":%d, \"status\":\"%s\", \"desiredVersion\":%d}}", 
-                propertyReported->name, propertyReported->value, propertyReported->statusCode, propertyReported->status, propertyReported->version);
-            
-            if (sendReportedProperty(buff)) {
-                Serial.printf("Desired property %s successfully echoed back as a reported property\r\n", propertyReported->name);
-                incrementReportedCount();
-            } else {
-                Serial.printf("Desired property %s failed to be echoed back as a reported property\r\n", propertyReported->name);
-                incrementErrorCount();
-            }
-            free(propertyReported->name);
-            free(propertyReported->value);
-            free(propertyReported->status);
-            free(propertyReported);
-        }
-        else {
-            break;
-        }
+    // the SDK hands over just the payload, methods without one get an invalid (empty) object
+    bool objectSent = startsObject(inboundMessageText());
+    StaticJsonBuffer<INBOUND_JSON_ARENA> jsonBuffer;
+    JsonObject& params = jsonBuffer.parseObject(inboundMessageText());
+    if (objectSent && !params.success()) {
+        Serial.printf("Device Method %s payload of %d bytes not parsed\r\n", methodName, inboundMessageLength());
+        methodResponseSet("{\"status\":\"payload is not a JSON object or has too many members\"}");
+        return 400;
     }
- }
-
-static void prepareReportedProperty(const char *propertyName, const char *value, int version, const char *status, int statusCode) {
-    TWIN_PROPERTY_REPORTED *propertyReported = (TWIN_PROPERTY_REPORTED*)calloc(1, sizeof(TWIN_PROPERTY_REPORTED));
-    propertyReported->name = strdup(propertyName);
-    propertyReported->value = strdup(value);
-    propertyReported->version = version;
-    propertyReported->status = strdup(status);
-    propertyReported->statusCode = statusCode;
-
-    queuePropertyReported.put(propertyReported);
+    return methodResponseInvoke(callback, params);
 }
 
-static void callDesiredCallback(const char *propertyName, JsonObject& jsonProperty) {
+static void callDesiredCallback(const char *propertyName, JsonObject& property, int version, bool useCache) {
     int status = 0;
-    char *methodResponse;
     
     // Parse the desired property
-    char value[200];
-    int version;
-        
-    if (jsonProperty.containsKey("desired")) {
-        jsonProperty["desired"][propertyName]["value"].printTo(value, sizeof(value));
-        version = jsonProperty["desired"]["$version"].as<signed int>();
-    } else {
-        jsonProperty[propertyName]["value"].printTo(value, sizeof(value));
-        version = jsonProperty["$version"].as<signed int>();
+    char value[TWIN_DIFF_VALUE_MAX];
+    bool valueFits = twinValueText(property, value, sizeof(value));
+
+    methodCallback callback = callbackTableFind(&desiredCallbacks, propertyName);
+    if (callback == NULL) {
+        return;
     }
 
-    for(int i = 0; i < desiredCallbackCount; i++) {
-        if (_stricmp(propertyName, desiredCallbackList[i].name) == 0) {
-            status = desiredCallbackList[i].callback(NULL, 0, &methodResponse, NULL);
-            prepareReportedProperty(propertyName, value, version, methodResponse, status);
-            free(methodResponse);
-            break;
-        }
+    // the echo carries the value as JSON, a cut off value would make the patch invalid
+    if (!valueFits) {
+        Serial.printf("key: %s value longer than %d characters rejected\r\n", propertyName, TWIN_DIFF_VALUE_MAX - 1);
+        incrementErrorCount();
+        reportDesiredProperty(propertyName, "null", version, "value too long", 413);
+        return;
+    }
+
+    // applied before a reboot but never acknowledged, so only the reported property is sent
+    if (useCache && twinCacheMatches(propertyName, value)) {
+        Serial.printf("key: %s already applied with this value\r\n", propertyName);
+        reportDesiredProperty(propertyName, value, version, "completed", 200);
+        return;
     }
+
+    status = methodResponseInvoke(callback, property);
+    reportDesiredProperty(propertyName, value, version, methodResponseText(), status);
+    twinCacheUpdate(propertyName, value);
+}
+
+static void applyTwinChange(const char *name, JsonObject& property, int version) {
+    callDesiredCallback(name, property, version, true);
 }
 
 static void deviceTwinGetStateCallback(DEVICE_TWIN_UPDATE_STATE updateState, const unsigned char *payLoad, int size)
@@ -253,45 +386,71 @@ static void deviceTwinGetStateCallback(DEVICE_TWIN_UPDATE_STATE updateState, con
     }
     
     char *buffer = (char *)calloc(size + 1, 1);
+    if (buffer == NULL) {
+        Serial.printf("Device twin of %d bytes dropped, out of memory\r\n", size);
+        return;
+    }
     memcpy(buffer, payLoad, size);
-    
+
+    INBOUND_REQUEST request;
+    request.type = INBOUND_TWIN;
+    request.updateState = updateState;
+    request.twin = buffer;
+    dispatchInbound(&request);
+
+    free(buffer);
+}
+
+static void processTwin(DEVICE_TWIN_UPDATE_STATE updateState, char *buffer) {
     DynamicJsonBuffer jsonBuffer;
     JsonObject& root = jsonBuffer.parseObject(buffer);
     
     if (updateState == DEVICE_TWIN_UPDATE_PARTIAL) {
+        int version = root["$version"].as<signed int>();
+        if (version <= lastDesiredVersion) {
+            Serial.printf("Desired properties version %d already applied\r\n", version);
+            return;
+        }
+
         Serial.println("Processing desired property");
         for (JsonObject::iterator it = root.begin(); it != root.end(); ++it) {
             if (it->key[0] != '$') {
-                callDesiredCallback(it->key, root);
+                callDesiredCallback(it->key, it->value.as<JsonObject>(), version, false);
             }
         }
+        // written before the echoes are acknowledged, after a reboot in between the complete
+        // twin of the reconnect still shows them unreported and they are sent again
+        lastDesiredVersion = version;
+        twinCacheCommit(version);
     } else {
-        // loop through all the desired properties
-        // look to see if the desired property has an associated reported property
-        // if so look if the versions match, if they match do nothing
-        // if they don't match then call the associated callback for the desired property
-        Serial.println("Processing complete twin");      
+        // every desired property without a matching reported value is acted upon, the twin
+        // cache skips the handlers of values applied before a reboot but not yet reported
         JsonObject& desired = root["desired"];
         JsonObject& reported = root["reported"];
+        int version = desired["$version"].as<signed int>();
 
-        for (JsonObject::iterator it = desired.begin(); it != desired.end(); ++it) {
-            if (it->key[0] != '$') {
-                if (reported.containsKey(it->key)) {
-                    if(reported[it->key]["value"] == desired[it->key]["value"]) {
-                        // Property found in reported and values match
-                        Serial.printf("key: %s found in reported and values match\r\n", it->key);
-                        // Move next
-                        continue;
-                    }
-                }
-                // Not exist in reported or values do not mismatch
-                Serial.printf("key: %s either not found in reported or values do not match\r\n", it->key);
-                callDesiredCallback(it->key, root);
-            }
+        Serial.println("Processing complete twin");
+        twinDiff(desired, reported, applyTwinChange);
+        if (version > lastDesiredVersion) {
+            lastDesiredVersion = version;
         }
+        twinCacheCommit(lastDesiredVersion);
     }
-    
-    free(buffer);
+}
+
+static void runInbound(INBOUND_REQUEST *request) {
+    switch (request->type) {
+        case INBOUND_MESSAGE:
+            processMessage();
+            break;
+        case INBOUND_METHOD:
+            request->status = processMethod(request->methodName);
+            break;
+        case INBOUND_TWIN:
+            processTwin(request->updateState, request->twin);
+            break;
+    }
+    request->handled = true;
 }
 
 static void deviceTwinConfirmationCallback(int status_code) {
@@ -321,5 +480,5 @@ void displayDeviceInfo() {
     }
 
     sprintf(buff, "Device:\r\n%s\r\n%.16s\r\nf/w: %s", deviceId.c_str(), displayHubName.c_str(), FW_VERSION);
-    Screen.print(0, buff);
+    displayPrint(0, buff);
 }
@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/jsonWriter.h"
+#include "../inc/utility.h"
+
+static void appendChar(JSON_WRITER *writer, char c) {
+    if (writer->overflow || writer->length + 1 >= writer->size) {
+        writer->overflow = true;
+        return;
+    }
+    writer->buffer[writer->length++] = c;
+    writer->buffer[writer->length] = 0;
+}
+
+static void appendText(JSON_WRITER *writer, const char *text) {
+    while (*text != 0) {
+        appendChar(writer, *text++);
+    }
+}
+
+static void appendQuoted(JSON_WRITER *writer, const char *text) {
+    appendChar(writer, '"');
+    while (*text != 0) {
+        if (*text == '"' || *text == '\\') {
+            appendChar(writer, '\\');
+        }
+        appendChar(writer, *text++);
+    }
+    appendChar(writer, '"');
+}
+
+// emits the separator and key for the next value in the current container
+static void beginValue(JSON_WRITER *writer, const char *key) {
+    if (writer->depth > 0) {
+        if (!writer->firstValue[writer->depth - 1]) {
+            appendChar(writer, ',');
+        }
+        writer->firstValue[writer->depth - 1] = false;
+    }
+
+    if (key != NULL) {
+        appendQuoted(writer, key);
+        appendChar(writer, ':');
+    }
+}
+
+static void openContainer(JSON_WRITER *writer, const char *key, char open) {
+    beginValue(writer, key);
+    if (writer->depth >= JSON_WRITER_MAX_DEPTH) {
+        writer->overflow = true;
+        return;
+    }
+    appendChar(writer, open);
+    writer->firstValue[writer->depth++] = true;
+}
+
+static void closeContainer(JSON_WRITER *writer, char close) {
+    if (writer->depth > 0) {
+        writer->depth--;
+    }
+    appendChar(writer, close);
+}
+
+void jsonWriterInit(JSON_WRITER *writer, char *buffer, int size) {
+    writer->buffer = buffer;
+    writer->size = size;
+    writer->length = 0;
+    writer->depth = 0;
+    writer->overflow = (size < 1);
+    if (size > 0) {
+        buffer[0] = 0;
+    }
+}
+
+void jsonWriterBeginObject(JSON_WRITER *writer, const char *key) {
+    openContainer(writer, key, '{');
+}
+
+void jsonWriterEndObject(JSON_WRITER *writer) {
+    closeContainer(writer, '}');
+}
+
+void jsonWriterBeginArray(JSON_WRITER *writer, const char *key) {
+    openContainer(writer, key, '[');
+}
+
+void jsonWriterEndArray(JSON_WRITER *writer) {
+    closeContainer(writer, ']');
+}
+
+void jsonWriterAddInt(JSON_WRITER *writer, const char *key, int value) {
+    char number[12];
+    sprintf(number, "%d", value);
+
+    beginValue(writer, key);
+    appendText(writer, number);
+}
+
+// counters that can pass INT_MAX
+void jsonWriterAddUnsigned(JSON_WRITER *writer, const char *key, unsigned long value) {
+    char number[24];
+    sprintf(number, "%lu", value);
+
+    beginValue(writer, key);
+    appendText(writer, number);
+}
+
+void jsonWriterAddFloat(JSON_WRITER *writer, const char *key, float value) {
+    // same formatting as String(float) so the payload text is unchanged
+    char number[20];
+    dtostrf(value, 4, 2, number);
+
+    beginValue(writer, key);
+    appendText(writer, number);
+}
+
+void jsonWriterAddString(JSON_WRITER *writer, const char *key, const char *value) {
+    beginValue(writer, key);
+    appendQuoted(writer, value);
+}
+
+void jsonWriterAddRaw(JSON_WRITER *writer, const char *key, const char *json) {
+    beginValue(writer, key);
+    appendText(writer, json);
+}
+
+// merges the members of an already serialized object into the current object
+void jsonWriterAddMembers(JSON_WRITER *writer, const char *object, int length) {
+    if (length < 2 || object[0] != '{' || object[length - 1] != '}') {
+        writer->overflow = true;
+        return;
+    }
+    if (length == 2) {
+        return;
+    }
+
+    beginValue(writer, NULL);
+    for (int i = 1; i < length - 1; i++) {
+        appendChar(writer, object[i]);
+    }
+}
+
+int jsonWriterLength(JSON_WRITER *writer) {
+    return writer->length;
+}
+
+// rolls the output back to an earlier length, e.g. to drop a value that did not fit
+void jsonWriterTruncate(JSON_WRITER *writer, int length) {
+    if (length < 0 || length > writer->length) {
+        return;
+    }
+    writer->length = length;
+    writer->buffer[length] = 0;
+    writer->overflow = false;
+}
+
+bool jsonWriterOverflow(JSON_WRITER *writer) {
+    return writer->overflow;
+}
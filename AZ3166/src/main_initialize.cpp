@@ -120,6 +120,15 @@ void processStartRequest(WiFiClient client) {
     client.write((uint8_t*)response.c_str(), strlen(response.c_str()));
 }
 
+// deadbands, the heartbeat and the batch settings are stored in a single byte each
+static uint8_t deadbandValue(String value) {
+    long number = value.toInt();
+    if (number < 0) {
+        return 0;
+    }
+    return (number > DEADBAND_VALUE_MAX) ? DEADBAND_VALUE_MAX : number;
+}
+
 void processResultRequest(WiFiClient client, String request) {
     String data = request.substring(request.indexOf('?') + 1, request.indexOf(" HTTP/"));
     char buff[data.length()+1];
@@ -129,6 +138,9 @@ void processResultRequest(WiFiClient client, String request) {
     String password = "";
     String connStr = "";
     uint8_t checkboxState = 0x00; // bit order - TEMP, HUMIDITY, PRESSURE, ACCELEROMETER, GYROSCOPE, MAGNETOMETER
+    uint8_t optionState = OPTIONS_PRESENT;
+    uint8_t deadbands[DEADBAND_CONFIG_LEN] = { 0 }; // TEMP, HUMIDITY, PRESSURE, ACCELEROMETER, GYROSCOPE, MAGNETOMETER, heartbeat
+    uint8_t batching[BATCH_CONFIG_LEN] = { 0 }; // samples per event, oldest sample age
     int error = 0;
 
     while (pch != NULL)
@@ -157,6 +169,26 @@ void processResultRequest(WiFiClient client, String request) {
             checkboxState = checkboxState | 0x08;
         } else if (key == "MAG") {
             checkboxState = checkboxState | 0x04;
+        } else if (key == "CBOR") {
+            optionState = optionState | CBOR_CHECKED;
+        } else if (key == "DTEMP") {
+            deadbands[0] = deadbandValue(value);
+        } else if (key == "DHUM") {
+            deadbands[1] = deadbandValue(value);
+        } else if (key == "DPRES") {
+            deadbands[2] = deadbandValue(value);
+        } else if (key == "DACCEL") {
+            deadbands[3] = deadbandValue(value);
+        } else if (key == "DGYRO") {
+            deadbands[4] = deadbandValue(value);
+        } else if (key == "DMAG") {
+            deadbands[5] = deadbandValue(value);
+        } else if (key == "HEART") {
+            deadbands[6] = deadbandValue(value);
+        } else if (key == "BATCH") {
+            batching[0] = deadbandValue(value);
+        } else if (key == "BATCHAGE") {
+            batching[1] = deadbandValue(value);
         }
 
         pch = strtok(NULL, "&");
@@ -165,9 +197,16 @@ void processResultRequest(WiFiClient client, String request) {
     // store the settings in EEPROM
     storeWiFi(ssid.c_str(), password.c_str());
     storeConnectionString(connStr.c_str());
-    char configData[4];
-    sprintf(configData, "!#%c", checkboxState);
-    storeIotCentralConfig(configData, 3);
+    char configData[BATCH_CONFIG_OFFSET + BATCH_CONFIG_LEN + 1];
+    sprintf(configData, "!#%c%c", checkboxState, optionState);
+    for (int i = 0; i < DEADBAND_CONFIG_LEN; i++) {
+        configData[DEADBAND_CONFIG_OFFSET + i] = deadbands[i] + 1;
+    }
+    for (int i = 0; i < BATCH_CONFIG_LEN; i++) {
+        configData[BATCH_CONFIG_OFFSET + i] = batching[i] + 1;
+    }
+    configData[BATCH_CONFIG_OFFSET + BATCH_CONFIG_LEN] = 0;
+    storeIotCentralConfig(configData, BATCH_CONFIG_OFFSET + BATCH_CONFIG_LEN);
 
     // redirect to the complete page
     String response = String(HTTP_STATUS_302) + "\r\nLocation: /complete\r\n\r\n\r\n";
@@ -5,6 +5,7 @@
 #include "SystemWiFi.h"
 #include <ArduinoJson.h>
 
+#include "../inc/iotCentral.h"
 #include "../inc/main_telemetry.h"
 #include "../inc/config.h"
 #include "../inc/wifi.h"
@@ -15,94 +16,71 @@
 #include "../inc/stats.h"
 #include "../inc/registeredMethodHandlers.h"
 #include "../inc/oledAnimation.h"
+#include "../inc/animationFrameData.h"
+#include "../inc/jsonWriter.h"
+#include "../inc/cborWriter.h"
+#include "../inc/deadband.h"
+#include "../inc/displayCache.h"
+#include "../inc/telemetryQueue.h"
+#include "../inc/timedOutput.h"
+#include "../inc/scheduler.h"
+#include "../inc/outboundWorker.h"
+#include "../inc/reportedProperties.h"
+#include "../inc/sensorSampler.h"
+#include "../inc/sensorStats.h"
+#include "../inc/methodJobs.h"
 
 #define traceOn false
 #define statePayloadTemplate "{\"%s\":\"%s\"}"
 
 // forward declarations
 void showState();
-void sendTelemetryPayload(const char *payload);
+void sendTelemetryPayload(const char *payload, int length, TelemetryEncoding encoding);
 void showState();
 void sendStateChange();
-void buildTelemetryPayload(String *payload);
+int buildTelemetryPayload(char *payload, int size);
 void rollDieAnimation(int value);
+static void timeSyncTask();
+static void buttonTask();
+static void samplingTask();
+static void telemetryTask();
+static void shakeTask();
+static void displayTask();
+static unsigned long schedulerMillis();
+static void telemetrySent(int samples, bool success);
+static void dieNumberSent(const char *payload, int properties, bool success);
 
 const int telemetrySendInterval = 5000;
+const int samplingInterval = 100;
+const int motionFifoRate = 416;
+const int timeSyncCheckInterval = 60000;
+const int twinEchoInterval = 50;
+const int buttonInterval = 20;
+const int shakeInterval = 50;
+const int displayInterval = 50;
+const int ledInterval = 10;
+const int methodJobInterval = 5;
+const int inboundInterval = 10;
 const int reportedSendInterval = 2000;
+const int ledFlashTime = 500;
+const int animationInterval = 10;
+const int irBurstInterval = 10;
+const int dieFrameInterval = 1000;
 
 static bool reset = false;
 const int switchDebounceTime = 250;
 static bool connected;
 unsigned long lastTimeSync = 0;
 unsigned long timeSyncPeriod = 7200000;
-unsigned long lastTelemetrySend = 0;
 unsigned long lastShakeTime = 0;
 unsigned long lastSwitchPress = 0;
 static int currentInfoPage = 0;
 static int lastInfoPage = -1;
+static int samplingTaskId = -1;
 uint8_t telemetryState = 0xFF;
+static TelemetryEncoding telemetryEncoding = TELEMETRY_JSON;
 
-static const char die1[] = { 
-    '1', 'T', 'T', 'T', 'T', 'T', 'T', '2',
-    '<', '.', '.', '.', '.', '.', '.', '>',
-    '<', '.', '.', '.', '.', '.', '.', '>',
-    '<', '.', '.', '!', '@', '.', '.', '>',
-    '<', '.', '.', '#', '$', '.', '.', '>',
-    '<', '.', '.', '.', '.', '.', '.', '>',
-    '<', '.', '.', '.', '.', '.', '.', '>',
-    '3', 'b', 'b', 'b', 'b', 'b', 'b', '4'};
-
-static const char die2[] = { 
-    '1', 'T', 'T', 'T', 'T', 'T', 'T', '2',
-    '<', '!', '@', '.', '.', '.', '.', '>',
-    '<', '#', '$', '.', '.', '.', '.', '>',
-    '<', '.', '.', '.', '.', '.', '.', '>',
-    '<', '.', '.', '.', '.', '.', '.', '>',
-    '<', '.', '.', '.', '.', '!', '@', '>',
-    '<', '.', '.', '.', '.', '#', '$', '>',
-    '3', 'b', 'b', 'b', 'b', 'b', 'b', '4'};
-
-static const char die3[] = { 
-    '1', 'T', 'T', 'T', 'T', 'T', 'T', '2',
-    '<', '!', '@', '.', '.', '.', '.', '>',
-    '<', '#', '$', '.', '.', '.', '.', '>',
-    '<', '.', '.', '!', '@', '.', '.', '>',
-    '<', '.', '.', '#', '$', '.', '.', '>',
-    '<', '.', '.', '.', '.', '!', '@', '>',
-    '<', '.', '.', '.', '.', '#', '$', '>',
-    '3', 'b', 'b', 'b', 'b', 'b', 'b', '4'};
-
-static const char die4[] = { 
-    '1', 'T', 'T', 'T', 'T', 'T', 'T', '2',
-    '<', '!', '@', '.', '.', '!', '@', '>',
-    '<', '#', '$', '.', '.', '#', '$', '>',
-    '<', '.', '.', '.', '.', '.', '.', '>',
-    '<', '.', '.', '.', '.', '.', '.', '>',
-    '<', '!', '@', '.', '.', '!', '@', '>',
-    '<', '#', '$', '.', '.', '#', '$', '>',
-    '3', 'b', 'b', 'b', 'b', 'b', 'b', '4'};
-
-static const char die5[] = { 
-    '1', 'T', 'T', 'T', 'T', 'T', 'T', '2',
-    '<', '!', '@', '.', '.', '!', '@', '>',
-    '<', '#', '$', '.', '.', '#', '$', '>',
-    '<', '.', '.', '!', '@', '.', '.', '>',
-    '<', '.', '.', '#', '$', '.', '.', '>',
-    '<', '!', '@', '.', '.', '!', '@', '>',
-    '<', '#', '$', '.', '.', '#', '$', '>',
-    '3', 'b', 'b', 'b', 'b', 'b', 'b', '4'};
-
-static const char die6[] = { 
-    '1', 'T', 'T', 'T', 'T', 'T', 'T', '2',
-    '<', '!', '@', '.', '.', '!', '@', '>',
-    '<', '#', '$', '.', '.', '#', '$', '>',
-    '<', '!', '@', '.', '.', '!', '@', '>',
-    '<', '#', '$', '.', '.', '#', '$', '>',
-    '<', '!', '@', '.', '.', '!', '@', '>',
-    '<', '#', '$', '.', '.', '#', '$', '>',
-    '3', 'b', 'b', 'b', 'b', 'b', 'b', '4'};
-
-static const char *die[] = { die1, die2, die3, die4, die5, die6 };
+static const unsigned char *die[] = { die1Frame, die2Frame, die3Frame, die4Frame, die5Frame, die6Frame };
 
 void telemetrySetup(String iotCentralConfig) {
     reset = false;
@@ -122,6 +100,9 @@ void telemetrySetup(String iotCentralConfig) {
     // Register callbacks for cloud to device messages
     registerMethod("message", cloudMessage);  // C2D message
     registerMethod("rainbow", directMethod);  // direct method
+    registerMethod("getSensorStats", sensorStatsMethod);  // direct method
+    registerMethod("getSchedulerStats", schedulerStatsMethod);  // direct method
+    registerMethod("getDeviceStats", deviceStatsMethod);  // direct method
 
     // register callbacks for desired properties expected
     registerDesiredProperty("fanSpeed", fanSpeedDesiredChange);
@@ -134,8 +115,66 @@ void telemetrySetup(String iotCentralConfig) {
 
     // clear all the stat counters
     clearCounters();
+    clearDisplayStats();
+    telemetryQueueClear();
+
+    // configs from before batching was added get the default batch
+    int batchSize = TELEMETRY_BATCH_DEFAULT;
+    unsigned long batchAge = TELEMETRY_BATCH_AGE_DEFAULT;
+    if (iotCentralConfig.length() >= BATCH_CONFIG_OFFSET + BATCH_CONFIG_LEN) {
+        uint8_t size = iotCentralConfig[BATCH_CONFIG_OFFSET] - 1;
+        uint8_t age = iotCentralConfig[BATCH_CONFIG_OFFSET + 1] - 1;
+        if (size != 0) {
+            batchSize = size;
+        }
+        if (age != 0) {
+            batchAge = age * 1000UL;
+        }
+    }
+    setTelemetryBatching(batchSize, batchAge);
+
+    // all sends to the hub happen on the outbound worker thread from here on
+    startOutboundWorker(telemetrySent);
 
     telemetryState = iotCentralConfig[2];
+    uint8_t options = (iotCentralConfig.length() > 3) ? iotCentralConfig[3] : 0;
+    if ((options & (OPTIONS_PRESENT | CBOR_CHECKED)) == (OPTIONS_PRESENT | CBOR_CHECKED)) {
+        if (binaryEventsSupported()) {
+            telemetryEncoding = TELEMETRY_CBOR;
+        } else {
+            Serial.println("CBOR telemetry is not supported by this DevKit SDK, sending JSON");
+        }
+    }
+
+    // older configs have no deadbands and send every channel every time
+    uint8_t deadbands[DEADBAND_CONFIG_LEN] = { 0 };
+    if (iotCentralConfig.length() >= DEADBAND_CONFIG_OFFSET + DEADBAND_CONFIG_LEN) {
+        for (int i = 0; i < DEADBAND_CONFIG_LEN; i++) {
+            deadbands[i] = iotCentralConfig[DEADBAND_CONFIG_OFFSET + i] - 1;
+        }
+    }
+    deadbandConfigure(deadbands, deadbands[DEADBAND_SENSOR_COUNT] * 60000UL);
+    clearAggregates();
+
+    // capture motion at a high rate in the LSM6DSL FIFO, fall back to point reads if it can't be set up
+    if ((telemetryState & (ACCEL_CHECKED | GYRO_CHECKED)) != 0 && !enableMotionFifo(motionFifoRate)) {
+        Serial.println("LSM6DSL FIFO capture not available, using single reads");
+    }
+
+    // everything the loop does runs as a periodic task so each rate can be tuned and measured
+    schedulerInit(schedulerMillis);
+    schedulerAddTask("leds", updateTimedOutputs, ledInterval);
+    schedulerAddTask("methodJobs", runMethodJobs, methodJobInterval);
+    schedulerAddTask("inbound", processInbound, inboundInterval);
+    schedulerAddTask("buttons", buttonTask, buttonInterval);
+    schedulerAddTask("twinEcho", echoDesiredProperty, twinEchoInterval);
+    schedulerAddTask("shake", shakeTask, shakeInterval);
+    samplingTaskId = schedulerAddTask("sampling", samplingTask, samplingInterval);
+    schedulerAddTask("telemetry", telemetryTask, telemetrySendInterval);
+    schedulerAddTask("animation", animationTask, animationInterval);
+    schedulerAddTask("irBurst", irBurstTask, irBurstInterval);
+    schedulerAddTask("display", displayTask, displayInterval);
+    schedulerAddTask("timeSync", timeSyncTask, timeSyncCheckInterval);
 }
 
 
@@ -146,17 +185,28 @@ void telemetryLoop() {
       return;
     }
 
+    unsigned long loopStart = millis();
+
     connected = (SystemWiFiSSID() != 0);
+
+    // run whichever tasks are due, earliest deadline first
+    schedulerRun();
+
+    recordLoopTime(millis() - loopStart);
+    
+    delay(1);  // good practice to help prevent lockups
+}
+
+static void timeSyncTask() {
     if (connected && (millis() - lastTimeSync > timeSyncPeriod)) {
         // re-sync the time from ntp
         if (SyncTimeToNTP()) {
             lastTimeSync = millis();
         }
     }
+}
 
-    // process desired property change to get echoed back as a reported property
-    echoDesiredProperty();
-
+static void buttonTask() {
     // look for button A pressed to signify state change
     // when the A button is pressed the device state rotates to the next value and a state telemetry message is sent
     if (IsButtonClicked(USER_BUTTON_A) && (millis() - lastSwitchPress > switchDebounceTime)) {
@@ -168,51 +218,64 @@ void telemetryLoop() {
    
     // look for button B pressed to page through info screens
     if (IsButtonClicked(USER_BUTTON_B) && (millis() - lastSwitchPress > switchDebounceTime)) {
-        currentInfoPage = (currentInfoPage + 1) % 3;
+        currentInfoPage = (currentInfoPage + 1) % 5;
+        animationCancel();
         lastSwitchPress = millis();
     }
+}
 
-    // example of sending telemetry data
-    if (millis() - lastTelemetrySend >= telemetrySendInterval) {
-        String payload; // max payload size for Azure IoT
+// the sensors are read many times per send window and only the aggregates are sent
+static void samplingTask() {
+    sampleSensors(telemetryState);
+}
+
+// example of sending telemetry data
+static void telemetryTask() {
+    static char payload[TELEMETRY_PAYLOAD_MAX];
 
-        buildTelemetryPayload(&payload);
+    // make sure the window holds the latest reading
+    sampleSensors(telemetryState);
 
-        sendTelemetryPayload(payload.c_str());
+    int length = buildTelemetryPayload(payload, sizeof(payload));
 
-        lastTelemetrySend = millis();
+    if (length > 0) {
+        sendTelemetryPayload(payload, length, telemetryEncoding);
     }
+}
 
-    // example of sending a device twin reported property when the accelerometer detects a double tap
+// example of sending a device twin reported property when the accelerometer detects a double tap
+static void shakeTask() {
     if (checkForShake() && (millis() - lastShakeTime > reportedSendInterval)) {
         String shakeProperty = F("{\"dieNumber\":{{die}}}");
         randomSeed(analogRead(0));
         int die = random(1, 7);
         shakeProperty.replace("{{die}}", String(die));
     
-        Screen.clean();
         rollDieAnimation(die);
 
-        if (sendReportedProperty(shakeProperty.c_str())) {
-            Serial.println("Reported property dieNumber successfully sent");
-            incrementReportedCount();
-        } else {
-            Serial.println("Reported property dieNumber failed to during sending");
+        if (!queueReportedProperty(shakeProperty.c_str(), 1, dieNumberSent)) {
+            Serial.println("Reported property dieNumber could not be queued for sending");
             incrementErrorCount();
         }
         lastShakeTime = millis();
     }
+}
 
-    // update the current display page
+// update the current display page
+static void displayTask() {
+    // animations and messages have the screen until they finish or are cancelled
+    if (animationRunning() || displayHeld()) {
+        return;
+    }
     if (currentInfoPage != lastInfoPage) {
-        Screen.clean();
+        displayInvalidate();
         lastInfoPage = currentInfoPage;
     }
     switch (currentInfoPage) {
         case 0: // message counts - page 1
             char buff[64];
             sprintf(buff, "%s\r\nsent: %d\r\nfail: %d\r\ntwin: %d/%d", connected?"-- Connected --":"- disconnected -", getTelemetryCount(), getErrorCount(), getDesiredCount(), getReportedCount());
-            Screen.print(0, buff);
+            displayPrint(0, buff);
             break;
         case 1: // Device information
             displayDeviceInfo();
@@ -220,14 +283,34 @@ void telemetryLoop() {
         case 2:  // Network information    
             displayNetworkInfo();
             break;
+        case 3:  // Sensor read timing
+            displaySensorInfo();
+            break;
+        case 4:  // OLED traffic, saved is against redrawing every line in full
+            char oled[64];
+            sprintf(oled, "-- display --\r\nsent %9luB\r\nsaved %6luB/s", getDisplayBytesWritten(), getDisplayBytesSavedPerSecond());
+            displayPrint(0, oled);
+            break;
     }
-    
-    delay(1);  // good practice to help prevent lockups
+}
+
+static unsigned long schedulerMillis() {
+    return millis();
+}
+
+void setSamplingInterval(unsigned long interval) {
+    schedulerSetPeriod(samplingTaskId, interval);
 }
 
 void telemetryCleanup() {
     reset = true;
 
+    clearTimedOutputs();
+
+    // release a hub callback waiting on this thread, then stop sending before the client goes away
+    closeInbound();
+    stopOutboundWorker();
+
     // cleanup the Azure IoT client
     closeIotHubClient();
 
@@ -235,84 +318,180 @@ void telemetryCleanup() {
     shutdownWiFi();
 }
 
-void buildTelemetryPayload(String *payload) {
-    *payload = "{";
-
-    // HTS221
-    float humidity = 0.0;
-    if ((telemetryState & HUMIDITY_CHECKED) == HUMIDITY_CHECKED) {
-        humidity = readHumidity();
-        payload->concat(",\"humidity\":");
-        payload->concat(String(humidity));
-    }
-
-    float temp = 0.0;
-    if ((telemetryState & TEMP_CHECKED) == TEMP_CHECKED) {
-        temp = readTemperature();
-        payload->concat(",\"temp\":");
-        payload->concat(String(temp));
-    }
-
-    // LPS22HB
-    float pressure = 0.0;
-    if ((telemetryState & PRESSURE_CHECKED) == PRESSURE_CHECKED) {
-        pressure = readPressure();
-        payload->concat(",\"pressure\":");
-        payload->concat(String(pressure));
-    }
-
-    // LIS2MDL
-    int magAxes[3];
-    if ((telemetryState & MAG_CHECKED) == MAG_CHECKED) {
-        readMagnetometer(magAxes);
-        payload->concat(",\"magnetometerX\":");
-        payload->concat(String(magAxes[0]));
-        payload->concat(",\"magnetometerY\":");
-        payload->concat(String(magAxes[1]));
-        payload->concat(",\"magnetometerZ\":");
-        payload->concat(String(magAxes[2]));
-    }
-
-    // LSM6DSL
-    int accelAxes[3];
-    if ((telemetryState & ACCEL_CHECKED) == ACCEL_CHECKED) {
-        readAccelerometer(accelAxes);
-        payload->concat(",\"accelerometerX\":");
-        payload->concat(String(accelAxes[0]));
-        payload->concat(",\"accelerometerY\":");
-        payload->concat(String(accelAxes[1]));
-        payload->concat(",\"accelerometerZ\":");
-        payload->concat(String(accelAxes[2]));
-    }
-
-    int gyroAxes[3];
-    if ((telemetryState & GYRO_CHECKED) == GYRO_CHECKED) {
-        readGyroscope(gyroAxes);
-        payload->concat(",\"gyroscopeX\":");
-        payload->concat(String(gyroAxes[0]));
-        payload->concat(",\"gyroscopeY\":");
-        payload->concat(String(gyroAxes[1]));
-        payload->concat(",\"gyroscopeZ\":");
-        payload->concat(String(gyroAxes[2]));
-    }
-
-    payload->concat("}");
-    payload->replace("{,", "{");
+static void addChannel(JSON_WRITER *writer, const SENSOR_CHANNEL *channel, const CHANNEL_AGGREGATE *aggregate) {
+    char key[32];
+
+    if (aggregate->count == 0) {
+        // every read in the window failed, send the sensor error value as before
+        jsonWriterAddInt(writer, channel->name, 0xFFFF);
+        return;
+    }
+
+    // the plain key carries the window mean so existing consumers keep working
+    if (channel->integer) {
+        jsonWriterAddInt(writer, channel->name, (int)lroundf(aggregate->mean));
+    } else {
+        jsonWriterAddFloat(writer, channel->name, aggregate->mean);
+    }
+
+    if (aggregate->count > 1) {
+        sprintf(key, "%sMin", channel->name);
+        jsonWriterAddFloat(writer, key, aggregate->min);
+        sprintf(key, "%sMax", channel->name);
+        jsonWriterAddFloat(writer, key, aggregate->max);
+        sprintf(key, "%sStdDev", channel->name);
+        jsonWriterAddFloat(writer, key, aggregateStdDev(aggregate));
+    }
 }
 
-void sendTelemetryPayload(const char *payload) {
-    // Serial.println(payload);
+// same fields as addChannel, encoded as CBOR
+static void addCborChannel(CBOR_WRITER *writer, const SENSOR_CHANNEL *channel, const CHANNEL_AGGREGATE *aggregate) {
+    char key[32];
 
-    if (sendTelemetry(payload)) {
+    if (aggregate->count == 0) {
+        cborWriterAddInt(writer, channel->name, 0xFFFF);
+        return;
+    }
+
+    if (channel->integer) {
+        cborWriterAddInt(writer, channel->name, (int)lroundf(aggregate->mean));
+    } else {
+        cborWriterAddFloat(writer, channel->name, aggregate->mean);
+    }
+
+    if (aggregate->count > 1) {
+        sprintf(key, "%sMin", channel->name);
+        cborWriterAddFloat(writer, key, aggregate->min);
+        sprintf(key, "%sMax", channel->name);
+        cborWriterAddFloat(writer, key, aggregate->max);
+        sprintf(key, "%sStdDev", channel->name);
+        cborWriterAddFloat(writer, key, aggregateStdDev(aggregate));
+    }
+}
+
+static bool channelEnabled(int channel) {
+    const SENSOR_CHANNEL *sensorChannel = getSensorChannel(channel);
+    return (telemetryState & sensorChannel->mask) == sensorChannel->mask;
+}
+
+// picks the channels that go into this send, a channel whose reads all failed is always sent
+static int selectChannels(const CHANNEL_AGGREGATE *window, bool *include) {
+    unsigned long now = millis();
+    int sent = 0;
+    int suppressed = 0;
+
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        include[i] = false;
+        if (!channelEnabled(i)) {
+            continue;
+        }
+        include[i] = (window[i].count == 0) || deadbandCheck(i, window[i].mean, now);
+        if (include[i]) {
+            sent++;
+        } else {
+            suppressed++;
+        }
+    }
+
+    addChannelReports(sent, suppressed);
+    return sent;
+}
+
+static int buildJsonTelemetry(const CHANNEL_AGGREGATE *window, const bool *include, unsigned long samples, char *payload, int size) {
+    JSON_WRITER writer;
+    jsonWriterInit(&writer, payload, size);
+    jsonWriterBeginObject(&writer, NULL);
+
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        if (include[i]) {
+            addChannel(&writer, getSensorChannel(i), &window[i]);
+        }
+    }
+
+    if (samples > 1) {
+        jsonWriterAddInt(&writer, "sampleCount", samples);
+    }
+
+    jsonWriterEndObject(&writer);
+    return jsonWriterOverflow(&writer) ? -1 : jsonWriterLength(&writer);
+}
+
+static int buildCborTelemetry(const CHANNEL_AGGREGATE *window, const bool *include, unsigned long samples, char *payload, int size) {
+    CBOR_WRITER writer;
+    cborWriterInit(&writer, (uint8_t*)payload, size);
+    cborWriterBeginMap(&writer, NULL);
+
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        if (include[i]) {
+            addCborChannel(&writer, getSensorChannel(i), &window[i]);
+        }
+    }
+
+    if (samples > 1) {
+        cborWriterAddInt(&writer, "sampleCount", samples);
+    }
+
+    cborWriterEndMap(&writer);
+    return cborWriterOverflow(&writer) ? -1 : cborWriterLength(&writer);
+}
+
+// sends the aggregates of the enabled channels that changed in the window since the last send,
+// returns 0 when no channel needs to be sent
+int buildTelemetryPayload(char *payload, int size) {
+    CHANNEL_AGGREGATE window[CHANNEL_COUNT];
+    bool include[CHANNEL_COUNT];
+    takeAggregates(window);
+
+    if (selectChannels(window, include) == 0) {
+        return 0;
+    }
+
+    unsigned long samples = 0;
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        if (channelEnabled(i) && window[i].count > samples) {
+            samples = window[i].count;
+        }
+    }
+
+    int length;
+    if (telemetryEncoding == TELEMETRY_CBOR) {
+        length = buildCborTelemetry(window, include, samples, payload, size);
+    } else {
+        length = buildJsonTelemetry(window, include, samples, payload, size);
+    }
+
+    if (length < 0) {
+        Serial.println("Telemetry payload exceeded the payload buffer");
+    }
+    return length;
+}
+
+// readings are queued first so they survive a dropped connection, the outbound worker
+// sends them in order once the connection is there
+void sendTelemetryPayload(const char *payload, int length, TelemetryEncoding encoding) {
+    telemetryQueuePush(payload, length, time(NULL), encoding);
+}
+
+// called from the outbound worker thread once queued telemetry was sent or failed
+static void telemetrySent(int samples, bool success) {
+    if (success) {
+        for (int i = 0; i < samples; i++) {
+            incrementTelemetryCount();
+        }
         // flash the Azure LED
-        digitalWrite(LED_AZURE, 1);
-        delay(500);
-        digitalWrite(LED_AZURE, 0);
-        incrementTelemetryCount();
+        pulseOutput(LED_AZURE, ledFlashTime);
+    } else {
+        incrementErrorCount();
+        pulseOutput(LED_USER, ledFlashTime);
+    }
+}
+
+static void dieNumberSent(const char *payload, int properties, bool success) {
+    if (success) {
+        Serial.println("Reported property dieNumber successfully sent");
+        incrementReportedCount();
     } else {
-        digitalWrite(LED_USER, 1);
-        delay(500);
-        digitalWrite(LED_USER, 0);
+        Serial.println("Reported property dieNumber failed to during sending");
         incrementErrorCount();
     }
 }
@@ -335,12 +514,12 @@ void sendStateChange() {
             strcpy(value, "UNKNOWN");
     }
 
-    sprintf(stateChangePayload, statePayloadTemplate, "deviceState", value);
-    sendTelemetryPayload(stateChangePayload);
+    int length = sprintf(stateChangePayload, statePayloadTemplate, "deviceState", value);
+    sendTelemetryPayload(stateChangePayload, length, TELEMETRY_JSON);
 }
 
 void rollDieAnimation(int value) {
-    const char *roll[5];
+    const unsigned char *roll[5];
 
     for (int i = 0; i < 4; i++) {
         int dieRoll = random(0, 6);
@@ -349,12 +528,5 @@ void rollDieAnimation(int value) {
 
     roll[4] = die[value - 1];
 
-    animationInit(roll, 5, 64, 0, 1000, true);
-
-    // show the animation
-    for(int i = 0; i < 4; i++) {
-        renderNextFrame();
-    }
-
-    animationEnd();
+    animationStart(roll, 5, 5, 0, dieFrameInterval, true);
 }
\ No newline at end of file
@@ -0,0 +1,109 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+
+#include "../inc/methodJobs.h"
+#include "../inc/jsonWriter.h"
+#include "../inc/outboundWorker.h"
+#include "../inc/stats.h"
+
+// method handlers hand their long running work to the scheduler here, so the hub
+// gets its response straight away
+typedef struct METHOD_JOB_TAG {
+    int id;
+    char name[METHOD_JOB_NAME_MAX];
+    methodJobStep step;
+    void *context;
+    unsigned long started;
+} METHOD_JOB;
+
+static METHOD_JOB jobs[METHOD_JOB_MAX];
+static Mutex jobLock;
+static int nextJobId = 1;
+
+static void jobReported(const char *payload, int properties, bool success) {
+    if (success) {
+        Serial.printf("Method job completion %s successfully reported\r\n", payload);
+        incrementReportedCount();
+    } else {
+        Serial.printf("Method job completion %s failed to be reported\r\n", payload);
+        incrementErrorCount();
+    }
+}
+
+static void reportJobCompleted(METHOD_JOB *job) {
+    char buff[OUTBOUND_PAYLOAD_MAX];
+    JSON_WRITER writer;
+
+    jsonWriterInit(&writer, buff, sizeof(buff));
+    jsonWriterBeginObject(&writer, NULL);
+    jsonWriterBeginObject(&writer, "methodJob");
+    jsonWriterAddInt(&writer, "jobId", job->id);
+    jsonWriterAddString(&writer, "method", job->name);
+    jsonWriterAddString(&writer, "status", "completed");
+    jsonWriterAddInt(&writer, "duration", (int)(millis() - job->started));
+    jsonWriterEndObject(&writer);
+    jsonWriterEndObject(&writer);
+
+    if (jsonWriterOverflow(&writer) || !queueReportedProperty(buff, 1, jobReported)) {
+        Serial.printf("Completion of method job %d could not be reported\r\n", job->id);
+        incrementErrorCount();
+    }
+}
+
+// returns the id of the new job or -1 when all job slots are busy
+int startMethodJob(const char *methodName, methodJobStep step, void *context) {
+    int jobId = -1;
+
+    jobLock.lock();
+    for (int i = 0; i < METHOD_JOB_MAX; i++) {
+        if (jobs[i].step == NULL) {
+            jobId = nextJobId++;
+            jobs[i].id = jobId;
+            snprintf(jobs[i].name, METHOD_JOB_NAME_MAX, "%s", methodName);
+            jobs[i].context = context;
+            jobs[i].started = millis();
+            jobs[i].step = step;
+            break;
+        }
+    }
+    jobLock.unlock();
+
+    return jobId;
+}
+
+bool isMethodJobRunning(int jobId) {
+    bool running = false;
+
+    jobLock.lock();
+    for (int i = 0; i < METHOD_JOB_MAX; i++) {
+        if (jobs[i].step != NULL && jobs[i].id == jobId) {
+            running = true;
+            break;
+        }
+    }
+    jobLock.unlock();
+
+    return running;
+}
+
+// scheduler task, advances every running job by one step
+void runMethodJobs() {
+    for (int i = 0; i < METHOD_JOB_MAX; i++) {
+        jobLock.lock();
+        METHOD_JOB job = jobs[i];
+        jobLock.unlock();
+
+        if (job.step == NULL || job.step(job.context)) {
+            continue;
+        }
+
+        reportJobCompleted(&job);
+
+        jobLock.lock();
+        jobs[i].step = NULL;
+        jobLock.unlock();
+    }
+}
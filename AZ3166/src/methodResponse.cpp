@@ -0,0 +1,50 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/methodResponse.h"
+#include "../inc/jsonWriter.h"
+
+// handlers only run on the main thread, one at a time
+static char methodResponse[METHOD_RESPONSE_MAX];
+
+int methodResponseInvoke(methodCallback callback, JsonObject& payload) {
+    methodResponse[0] = 0;
+    int status = callback(payload, methodResponse, sizeof(methodResponse));
+    methodResponse[sizeof(methodResponse) - 1] = 0;
+    return status;
+}
+
+const char *methodResponseText() {
+    return methodResponse;
+}
+
+void methodResponseSet(const char *text) {
+    snprintf(methodResponse, sizeof(methodResponse), "%s", text);
+}
+
+// the SDK frees the method response, so it gets its own heap copy of the arena contents
+void methodResponseToSdk(const char *text, unsigned char **response, int *responseSize) {
+    // only used from the SDK callbacks, which run one at a time
+    static char quoted[METHOD_RESPONSE_MAX];
+
+    // a method response body has to be JSON, plain text responses are sent as a JSON string
+    if (text[0] == 0) {
+        text = "{}";
+    } else if (text[0] != '{' && text[0] != '[' && text[0] != '"') {
+        JSON_WRITER writer;
+        jsonWriterInit(&writer, quoted, sizeof(quoted));
+        jsonWriterAddString(&writer, NULL, text);
+        text = jsonWriterOverflow(&writer) ? "{}" : quoted;
+    }
+
+    int length = strlen(text);
+    *response = (unsigned char *)malloc(length);
+    if (*response == NULL) {
+        *responseSize = 0;
+        return;
+    }
+    memcpy(*response, text, length);
+    *responseSize = length;
+}
@@ -2,165 +2,164 @@
 // Licensed under the MIT license. 
 
 #include "Arduino.h"
+#include "mbed.h"
 #include "OledDisplay.h"
 
 #include "../inc/oledAnimation.h"
-
-static int frameCount;
+#include "../inc/displayCache.h"
+
+// the frames and timing of an animation, the frame list is copied so callers can
+// build it on the stack
+typedef struct ANIMATION_TAG {
+    const unsigned char *frames[ANIMATION_MAX_FRAMES];
+    int frameCount;
+    int totalFrames;
+    int moveLimit;
+    unsigned long frameInterval;
+    bool center;
+} ANIMATION;
+
+// requests from the handlers, taken over by animationTask on its next tick
+static ANIMATION pending;
+static volatile bool startPending = false;
+static volatile bool cancelPending = false;
+static Mutex animationLock;
+
+// the animation on the screen, only changed by animationTask
+static ANIMATION animation;
+static volatile bool running = false;
+static int framesShown;
 static int move;
+static unsigned long nextFrameAt;
 
 static unsigned char xs = 0;
 static unsigned char ys = 0;
 static unsigned char xe = 128;
 static unsigned char ye = 8;
 
-const unsigned char block[]  = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
-const unsigned char blockGap[]  = {0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E};
-const unsigned char blockVGap[]  = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
-const unsigned char cross[]  = {0x81, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42, 0x81};
-const unsigned char diagRL[] = {0xC0, 0xE0, 0x70, 0x38, 0x1C, 0x0E, 0x07, 0x03};
-const unsigned char diagLR[] = {0x03, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xC0};
-const unsigned char horzB[]  = {0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01};
-const unsigned char horzT[]  = {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
-const unsigned char vertL[]  = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF};
-const unsigned char vertR[]  = {0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-const unsigned char circle[] = {0x18, 0x7E, 0x7E, 0xFF, 0xFF, 0x7E, 0x7E, 0x18};
-const unsigned char clear[]  = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-const unsigned char borderBottom[]  = {0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0};
-const unsigned char borderTop[]  = {0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03};
-const unsigned char borderLeft[]  = {0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-const unsigned char borderRight[]  = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF};
-const unsigned char cornerLB[]  = {0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0};
-const unsigned char cornerRB[]  = {0xC0, 0x00, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF};
-const unsigned char cornerLT[]  = {0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03};
-const unsigned char cornerRT[]  = {0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFF, 0xFF};
-const unsigned char circleLT[]  = {0x00, 0xF0, 0xF8, 0xFC, 0xFC, 0xFE, 0xFE, 0xFE};
-const unsigned char circleRT[]  = {0xFE, 0xFE, 0xFE, 0xFC, 0xFC, 0xF8, 0xF0, 0x00};
-const unsigned char circleLB[]  = {0x00, 0x0F, 0x1F, 0x3F, 0x3F, 0x7F, 0x7F, 0x7F};
-const unsigned char circleRB[]  = {0x7F, 0x7F, 0x7F, 0x3F, 0x3F, 0x1F, 0x0F, 0x00};
-
-static unsigned char* buf;
-static unsigned char* blankBuf;
-
-static int _maxFrames;
-static int _width;
-static int _moveLimit;
-static int _frameDelay;
-static bool _center;
-static const char **_frames;
-
-void animationInit(const char **frames, int maxFrames, int width, int moveLimit, int frameDelay, bool center) {
-    frameCount = 0;
-    move = 0;
-
-    _frames = frames;
-    _maxFrames = maxFrames - 1;
-    _width = width;
-    _moveLimit = moveLimit;
-    _frameDelay = frameDelay;
-    _center = center;
-
-    buf = (unsigned char*)calloc(1024, 1);
-    blankBuf = (unsigned char*)calloc(64, 1);
-    
-    renderNextFrame();
-}
+// one blank page row, wide enough for the whole screen and the column a moving frame leaves
+static const unsigned char blankPage[128] = { 0 };
 
-void clearScreen() {
-    memset(buf, 0x00, 1024);
-    Screen.draw(0, 0, 128, 64, buf);
+// holds the screen and the animation state for its lifetime and lets go of both on every
+// way out, the screen lock is always taken first
+class AnimationScope {
+public:
+    AnimationScope() {
+        displayLock();
+        animationLock.lock();
+    }
+    ~AnimationScope() {
+        animationLock.unlock();
+        displayUnlock();
+    }
+
+private:
+    AnimationScope(const AnimationScope&);
+    AnimationScope& operator=(const AnimationScope&);
+};
+
+// returns false if the animation has more frames than can be held
+bool animationStart(const unsigned char **frames, int frameCount, int totalFrames, int moveLimit, unsigned long frameInterval, bool center) {
+    if (frameCount <= 0 || frameCount > ANIMATION_MAX_FRAMES) {
+        return false;
+    }
+
+    animationLock.lock();
+    memcpy(pending.frames, frames, frameCount * sizeof(frames[0]));
+    pending.frameCount = frameCount;
+    pending.totalFrames = totalFrames;
+    pending.moveLimit = moveLimit;
+    pending.frameInterval = frameInterval;
+    pending.center = center;
+    startPending = true;
+    cancelPending = false;
+    animationLock.unlock();
+
+    return true;
 }
 
-void renderNextFrame() {
-    int columnPad = 3;
-    
-    memset(buf, 0x00, 1024);
-    const char *image;
+void animationCancel() {
+    animationLock.lock();
+    startPending = false;
+    cancelPending = true;
+    animationLock.unlock();
+}
 
-    image = _frames[frameCount];
+bool animationRunning() {
+    return running || startPending;
+}
 
-    if (frameCount < _maxFrames)
-        frameCount++;
-    else
-        frameCount = 0;
-    int colLimit = _width / 8;
-
-    for(int y = 0; y < 8; y++) {
-        for(int x = 0; x < colLimit; x++) {
-            if (image[(y * colLimit) + x] == 'B')
-                memcpy(buf + columnPad, block, 8);
-            else if (image[(y * colLimit) + x] == 'G')
-                memcpy(buf + columnPad, blockGap, 8);
-            else if (image[(y * colLimit) + x] == 'g')
-                memcpy(buf + columnPad, blockVGap, 8);                
-            else if (image[(y * colLimit) + x] == 'X')
-                memcpy(buf + columnPad, cross, 8);
-            else if (image[(y * colLimit) + x] == 'L')
-                memcpy(buf + columnPad, diagLR, 8);
-            else if (image[(y * colLimit) + x] == 'R')
-                memcpy(buf + columnPad, diagRL, 8);
-            else if (image[(y * colLimit) + x] == 'H')
-                memcpy(buf + columnPad, horzT, 8);
-            else if (image[(y * colLimit) + x] == 'h')
-                memcpy(buf + columnPad, horzB, 8);
-            else if (image[(y * colLimit) + x] == 'V')
-                memcpy(buf + columnPad, vertL, 8);
-            else if (image[(y * colLimit) + x] == 'v')
-                memcpy(buf + columnPad, vertR, 8);
-            else if (image[(y * colLimit) + x] == 'O')
-                memcpy(buf + columnPad, circle, 8);
-            else if (image[(y * colLimit) + x] == '.')
-                memcpy(buf + columnPad, clear, 8);
-            else if (image[(y * colLimit) + x] == 'T')
-                memcpy(buf + columnPad, borderTop, 8);
-            else if (image[(y * colLimit) + x] == 'b')
-                memcpy(buf + columnPad, borderBottom, 8);
-            else if (image[(y * colLimit) + x] == '<')
-                memcpy(buf + columnPad, borderLeft, 8);
-            else if (image[(y * colLimit) + x] == '>')
-                memcpy(buf + columnPad, borderRight, 8);
-            else if (image[(y * colLimit) + x] == '1')
-                memcpy(buf + columnPad, cornerLT, 8);
-            else if (image[(y * colLimit) + x] == '2')
-                memcpy(buf + columnPad, cornerRT, 8);
-            else if (image[(y * colLimit) + x] == '3')
-                memcpy(buf + columnPad, cornerLB, 8);
-            else if (image[(y * colLimit) + x] == '4')
-                memcpy(buf + columnPad, cornerRB, 8);
-            else if (image[(y * colLimit) + x] == '!')
-                memcpy(buf + columnPad, circleLT, 8);
-            else if (image[(y * colLimit) + x] == '@')
-                memcpy(buf + columnPad, circleRT, 8);
-            else if (image[(y * colLimit) + x] == '#')
-                memcpy(buf + columnPad, circleLB, 8);
-            else if (image[(y * colLimit) + x] == '$')
-                memcpy(buf + columnPad, circleRB, 8);
-
-            columnPad = columnPad + 8;
-        }
-        columnPad = columnPad + 8;
+void clearScreen() {
+    displayLock();
+    for (int y = 0; y < 8; y++) {
+        Screen.draw(0, y, 128, y + 1, (unsigned char *)blankPage);
     }
-    
-    if (_moveLimit > 0)
-        Screen.draw(xs + move - 8, ys, xs+move, 8, blankBuf);
+    displayUnlock();
+}
+
+// frames are packed by tools/packFrames.py so each one is drawn as it is stored
+static void drawFrame(const unsigned char *image) {
+    if (animation.moveLimit > 0)
+        Screen.draw(xs + move - 8, ys, xs+move, 8, (unsigned char *)blankPage);
 
     int centerPad = 0;
-    if (_center)
-        centerPad = (126 - _width) / 2;
+    if (animation.center)
+        centerPad = (126 - ANIMATION_FRAME_WIDTH) / 2;
 
-    xe = _width + 8 + move + centerPad;
-    Screen.draw(xs + move + centerPad, ys, xe, ye, buf);
+    xe = ANIMATION_FRAME_WIDTH + 8 + move + centerPad;
+    // draw only reads the bitmap, it is declared without const in the SDK
+    Screen.draw(xs + move + centerPad, ys, xe, ye, (unsigned char *)image);
 
-    if (move / 8 < _moveLimit)
+    if (move / 8 < animation.moveLimit)
         move = move + 8;
     else
         move = 0;
-    
-    if (_frameDelay > 0)
-        delay(_frameDelay);
 }
 
-void animationEnd() {
-    free(buf);
-    free(blankBuf);
-}
\ No newline at end of file
+// hands the screen back to the info pages
+static void finishAnimation() {
+    running = false;
+    displayInvalidate();
+}
+
+// draws the next frame once it is due, the last frame stays up for one frame interval,
+// called with the animation context held
+static void stepAnimation(unsigned long now) {
+    if (startPending) {
+        animation = pending;
+        startPending = false;
+        Screen.clean();
+        framesShown = 0;
+        move = 0;
+        nextFrameAt = now;
+        running = true;
+    } else if (cancelPending && running) {
+        finishAnimation();
+    }
+    cancelPending = false;
+
+    if (!running || (long)(now - nextFrameAt) < 0) {
+        return;
+    }
+
+    if (framesShown >= animation.totalFrames) {
+        finishAnimation();
+        return;
+    }
+
+    drawFrame(animation.frames[framesShown % animation.frameCount]);
+    framesShown++;
+
+    // a late tick moves the schedule on rather than drawing a burst of frames to catch up
+    nextFrameAt += animation.frameInterval;
+    if ((long)(now - nextFrameAt) >= 0) {
+        nextFrameAt = now + animation.frameInterval;
+    }
+}
+
+// the lock is held while a frame is drawn, so once animationCancel returns nothing
+// more is drawn and the caller can use the screen
+void animationTask() {
+    AnimationScope scope;
+    stepAnimation(millis());
+}
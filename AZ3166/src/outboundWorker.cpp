@@ -0,0 +1,212 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+#include "SystemWiFi.h"
+
+#include "../inc/outboundWorker.h"
+#include "../inc/iotHubClient.h"
+#include "../inc/telemetryQueue.h"
+#include "../inc/stats.h"
+
+// every event sent to the hub goes through this thread so a slow network never stalls the loop
+typedef struct OUTBOUND_MESSAGE_TAG {
+    reportedCompleteCallback onComplete;
+    int properties;
+    char payload[OUTBOUND_PAYLOAD_MAX];
+} OUTBOUND_MESSAGE;
+
+static const int workerPollInterval = 100;
+static const int telemetryBatchPayloadMax = 4096;
+static const unsigned long telemetryRetryMin = 5000;
+static const unsigned long telemetryRetryMax = 80000;
+
+static MemoryPool<OUTBOUND_MESSAGE, OUTBOUND_QUEUE_DEPTH> messagePool;
+static Queue<OUTBOUND_MESSAGE, OUTBOUND_QUEUE_DEPTH> messageQueue;
+static Thread *workerThread = NULL;
+static volatile bool workerRunning = false;
+static telemetryCompleteCallback telemetryComplete = NULL;
+
+// a batch size of 1 sends every sample as its own event
+static int telemetryBatchSize = TELEMETRY_BATCH_DEFAULT;
+static unsigned long telemetryBatchMaxAge = TELEMETRY_BATCH_AGE_DEFAULT;
+static char batchPayload[telemetryBatchPayloadMax];
+static TELEMETRY_RECORD sendRecord;
+
+// after a failed send the queue waits, doubling the wait on every further failure
+static unsigned long retryBackoff = 0;
+static unsigned long retryAt = 0;
+static unsigned long sendingSequence = 0;
+static unsigned long failedSequence = 0;
+
+// returns the number of samples sent, 0 if nothing is due and -1 on a failed send
+static int sendTelemetryRecord() {
+    if (!telemetryQueueCopyOldest(&sendRecord)) {
+        return 0;
+    }
+    sendingSequence = sendRecord.sequence;
+    if (!sendTelemetry(sendRecord.payload, sendRecord.length, sendRecord.timestamp, sendRecord.encoding)) {
+        return -1;
+    }
+    telemetryQueueRelease(sendRecord.sequence);
+    return 1;
+}
+
+static int sendTelemetryBatch() {
+    // hold the samples until the batch is full or the oldest one gets too old
+    if (telemetryQueueCount() < telemetryBatchSize && telemetryQueueOldestAge() < telemetryBatchMaxAge) {
+        return 0;
+    }
+
+    TELEMETRY_BATCH batch;
+    int length = telemetryQueueBuildBatch(batchPayload, sizeof(batchPayload), telemetryBatchSize, &batch);
+    if (length < 0) {
+        return 0;
+    }
+
+    sendingSequence = batch.firstSequence;
+    if (!sendTelemetry(batchPayload, length, batch.timestamp, batch.encoding)) {
+        return -1;
+    }
+    telemetryQueueRelease(batch.lastSequence);
+
+    int unbatchedBytes = batch.recordBytes + batch.records * TELEMETRY_MESSAGE_OVERHEAD;
+    addBatchSavings(batch.records, unbatchedBytes - (length + TELEMETRY_MESSAGE_OVERHEAD));
+
+    return batch.records;
+}
+
+// a record is reported as failed once however many retries it takes
+static void telemetryFailed() {
+    if (retryBackoff == 0 || sendingSequence != failedSequence) {
+        failedSequence = sendingSequence;
+        if (telemetryComplete != NULL) {
+            telemetryComplete(0, false);
+        }
+    }
+
+    retryBackoff = (retryBackoff == 0) ? telemetryRetryMin : retryBackoff * 2;
+    if (retryBackoff > telemetryRetryMax) {
+        retryBackoff = telemetryRetryMax;
+    }
+    retryAt = millis() + retryBackoff;
+}
+
+// queued readings go out in order whenever the device is connected, returns true if
+// anything was handed to the hub client
+static bool drainTelemetry() {
+    if (retryBackoff > 0 && (long)(millis() - retryAt) < 0) {
+        return false;
+    }
+
+    bool sent = false;
+    while (workerRunning && telemetryQueueCount() > 0) {
+        int samples = (telemetryBatchSize > 1) ? sendTelemetryBatch() : sendTelemetryRecord();
+        if (samples == 0) {
+            break;
+        }
+        sent = true;
+        if (samples < 0) {
+            telemetryFailed();
+            break;
+        }
+
+        retryBackoff = 0;
+        if (telemetryComplete != NULL) {
+            telemetryComplete(samples, true);
+        }
+    }
+    return sent;
+}
+
+// inbound traffic is only delivered while the hub client works, so a poll that sent
+// nothing lets it check for commands and twin updates instead
+static void outboundWorker() {
+    while (workerRunning) {
+        bool sent = false;
+        osEvent evt = messageQueue.get(workerPollInterval);
+        if (evt.status == osEventMessage) {
+            OUTBOUND_MESSAGE *message = (OUTBOUND_MESSAGE*)evt.value.p;
+            bool success = sendReportedProperty(message->payload);
+            if (message->onComplete != NULL) {
+                message->onComplete(message->payload, message->properties, success);
+            }
+            messagePool.free(message);
+            sent = true;
+        }
+
+        if (SystemWiFiSSID() == 0) {
+            continue;
+        }
+        if (!drainTelemetry() && !sent && workerRunning) {
+            checkIotHubClient();
+        }
+    }
+}
+
+bool startOutboundWorker(telemetryCompleteCallback onTelemetryComplete) {
+    if (workerThread != NULL) {
+        return false;
+    }
+
+    telemetryComplete = onTelemetryComplete;
+    retryBackoff = 0;
+    workerRunning = true;
+    workerThread = new Thread(osPriorityNormal, OUTBOUND_WORKER_STACK_SIZE);
+    workerThread->start(outboundWorker);
+
+    return true;
+}
+
+// waits for the message in flight, anything still queued is discarded
+void stopOutboundWorker() {
+    if (workerThread == NULL) {
+        return;
+    }
+
+    workerRunning = false;
+    workerThread->join();
+    delete workerThread;
+    workerThread = NULL;
+
+    while (true) {
+        osEvent evt = messageQueue.get(0);
+        if (evt.status != osEventMessage) {
+            break;
+        }
+        messagePool.free((OUTBOUND_MESSAGE*)evt.value.p);
+    }
+}
+
+// the payload is copied, returns false and counts the backpressure when the queue is full
+bool queueReportedProperty(const char *payload, int properties, reportedCompleteCallback onComplete) {
+    int length = strlen(payload);
+    OUTBOUND_MESSAGE *message = (length < OUTBOUND_PAYLOAD_MAX) ? messagePool.alloc() : NULL;
+    if (message == NULL) {
+        incrementBackpressureCount();
+        return false;
+    }
+
+    memcpy(message->payload, payload, length + 1);
+    message->properties = properties;
+    message->onComplete = onComplete;
+    if (messageQueue.put(message) != osOK) {
+        messagePool.free(message);
+        incrementBackpressureCount();
+        return false;
+    }
+
+    return true;
+}
+
+void setTelemetryBatching(int batchSize, unsigned long maxAge) {
+    if (batchSize < 1) {
+        batchSize = 1;
+    } else if (batchSize > TELEMETRY_QUEUE_DEPTH) {
+        batchSize = TELEMETRY_QUEUE_DEPTH;
+    }
+
+    telemetryBatchSize = batchSize;
+    telemetryBatchMaxAge = maxAge;
+}
@@ -9,266 +9,247 @@
 #include "../inc/stats.h"
 #include "../inc/device.h"
 #include "../inc/oledAnimation.h"
+#include "../inc/animationFrameData.h"
+#include "../inc/sensorStats.h"
+#include "../inc/scheduler.h"
+#include "../inc/methodJobs.h"
+#include "../inc/displayCache.h"
+#include "../inc/reportedProperties.h"
+#include "../inc/iotHubClient.h"
+#include "../inc/jsonWriter.h"
 
 #include "../inc/fanSound.h"
 
-static const char fan1[] = { 
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', 'L', '.', '.', '.', '.', 'R', '.',
-    '.', '.', 'L', '.', '.', 'R', '.', '.',
-    '.', '.', '.', 'X', 'X', '.', '.', '.',
-    '.', '.', '.', 'X', 'X', '.', '.', '.',
-    '.', '.', 'R', '.', '.', 'L', '.', '.',
-    '.', 'R', '.', '.', '.', '.', 'L', '.'};
-
-static const char fan2[] = { 
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', 'V', 'v', '.', '.', '.',
-    '.', '.', '.', 'V', 'v', '.', '.', '.',
-    '.', 'H', 'H', 'X', 'X', 'H', 'H', '.',
-    '.', 'h', 'h', 'X', 'X', 'h', 'h', '.',
-    '.', '.', '.', 'V', 'v', '.', '.', '.',
-    '.', '.', '.', 'V', 'v', '.', '.', '.'};
-
-static const char voltage0[] = { 
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.'};
-
-static const char voltage1[] = { 
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G'};
-        
-static const char voltage2[] = { 
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G'};
-
-static const char voltage3[] = { 
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G'};
-
-static const char voltage4[] = { 
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G',
-    'G', 'G', 'G', 'G', 'G', 'G', 'G', 'G'};
-
-static const char current0[] = { 
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.',
-    '.', '.', '.', '.', '.', '.', '.', '.'};
-
-static const char current1[] = { 
-    'g', 'g', '.', '.', '.', '.', '.', '.',
-    'g', 'g', '.', '.', '.', '.', '.', '.',
-    'g', 'g', '.', '.', '.', '.', '.', '.',
-    'g', 'g', '.', '.', '.', '.', '.', '.',
-    'g', 'g', '.', '.', '.', '.', '.', '.',
-    'g', 'g', '.', '.', '.', '.', '.', '.',
-    'g', 'g', '.', '.', '.', '.', '.', '.',
-    'g', 'g', '.', '.', '.', '.', '.', '.'};
-        
-static const char current2[] = { 
-    'g', 'g', 'g', 'g', '.', '.', '.', '.',
-    'g', 'g', 'g', 'g', '.', '.', '.', '.',
-    'g', 'g', 'g', 'g', '.', '.', '.', '.',
-    'g', 'g', 'g', 'g', '.', '.', '.', '.',
-    'g', 'g', 'g', 'g', '.', '.', '.', '.',
-    'g', 'g', 'g', 'g', '.', '.', '.', '.',
-    'g', 'g', 'g', 'g', '.', '.', '.', '.',
-    'g', 'g', 'g', 'g', '.', '.', '.', '.'};
-
-static const char current3[] = { 
-    'g', 'g', 'g', 'g', 'g', 'g', '.', '.',
-    'g', 'g', 'g', 'g', 'g', 'g', '.', '.',
-    'g', 'g', 'g', 'g', 'g', 'g', '.', '.',
-    'g', 'g', 'g', 'g', 'g', 'g', '.', '.',
-    'g', 'g', 'g', 'g', 'g', 'g', '.', '.',
-    'g', 'g', 'g', 'g', 'g', 'g', '.', '.',
-    'g', 'g', 'g', 'g', 'g', 'g', '.', '.',
-    'g', 'g', 'g', 'g', 'g', 'g', '.', '.'};
-
-static const char current4[] = { 
-    'g', 'g', 'g', 'g', 'g', 'g', 'g', 'g',
-    'g', 'g', 'g', 'g', 'g', 'g', 'g', 'g',
-    'g', 'g', 'g', 'g', 'g', 'g', 'g', 'g',
-    'g', 'g', 'g', 'g', 'g', 'g', 'g', 'g',
-    'g', 'g', 'g', 'g', 'g', 'g', 'g', 'g',
-    'g', 'g', 'g', 'g', 'g', 'g', 'g', 'g',
-    'g', 'g', 'g', 'g', 'g', 'g', 'g', 'g',
-    'g', 'g', 'g', 'g', 'g', 'g', 'g', 'g'};
-
- 
-static const char *fan[] = {fan1, fan2};
-static const char *voltage[] = {voltage0, voltage1, voltage2, voltage3, voltage4, voltage3, voltage2, voltage1, voltage0};
-static const char *current[] = {current0, current1, current2, current3, current4, current3, current2, current1, current0};
+static const unsigned char *fan[] = {fan1Frame, fan2Frame};
+static const unsigned char *voltage[] = {voltage0Frame, voltage1Frame, voltage2Frame, voltage3Frame, voltage4Frame, voltage3Frame, voltage2Frame, voltage1Frame, voltage0Frame};
+static const unsigned char *current[] = {current0Frame, current1Frame, current2Frame, current3Frame, current4Frame, current3Frame, current2Frame, current1Frame, current0Frame};
+
+// frames shown and time between frames for the desired property animations
+static const int fanAnimationFrames = 100;
+static const int fanFrameInterval = 20;
+static const int levelAnimationFrames = 54;
+static const int levelFrameInterval = 30;
 
 static const char *response_completed = "completed";
 static const int successStatusCode = 200;
+static const int acceptedStatusCode = 202;
+static const int busyStatusCode = 409;
+static const int errorStatusCode = 500;
+static const unsigned long messageHoldTime = 2000;
+static const unsigned long irHoldTime = 1000;
 
 // handler for the cloud to device (C2D) message
-int cloudMessage(const char *payload, size_t size, char **response, size_t* resp_size) {
+int cloudMessage(JsonObject& payload, char *response, size_t responseSize) {
     Serial.println("Cloud to device (C2D) message recieved");
     
     // get parameters
-    DynamicJsonBuffer jsonBuffer;
-    JsonObject& root = jsonBuffer.parseObject(payload);
-    String text = root["text"];
+    const char *text = payload["text"];
+    if (text == NULL) {
+        text = "";
+    }
 
-    // display the message on the screen
-    Screen.clean();
-    Screen.print(0, "New message:");
-    Screen.print(1, text.c_str(), true);
-    delay(2000);
+    // display the message on the screen, the info pages come back once it was up long enough
+    animationCancel();
+    displayMessage("New message:", text, messageHoldTime);
 
     return successStatusCode;
 }
 
-int directMethod(const char *payload, size_t size, char **response, size_t* resp_size) {
-    // make the RGB LED color cycle
+// the rainbow effect cross-fades the RGB LED one 5 ms step per scheduler tick
+typedef enum {
+    RAINBOW_START,
+    RAINBOW_FADE,
+    RAINBOW_FINISH,
+    RAINBOW_RESTORE
+} RainbowPhase;
+
+typedef struct RAINBOW_JOB_TAG {
+    RainbowPhase phase;
+    int cycles;
+    int cycle;
+    int decColour;
+    int step;
     unsigned int rgbColour[3];
+    unsigned long resumeAt;
+} RAINBOW_JOB;
 
-    turnLedOff();
-    delay(100);
+static RAINBOW_JOB rainbowJob;
+static int rainbowJobId = -1;
 
-    DynamicJsonBuffer jsonBuffer;
-    JsonObject& root = jsonBuffer.parseObject(payload);
-    int cycles = root["cycles"];
+static bool rainbowStep(void *context) {
+    RAINBOW_JOB *job = (RAINBOW_JOB*)context;
+    if ((long)(millis() - job->resumeAt) < 0) {
+        return true;
+    }
 
-    for(int iter = 0; iter < cycles; iter++) {
-        // Start off with red.
-        rgbColour[0] = 255;
-        rgbColour[1] = 0;
-        rgbColour[2] = 0;  
+    switch (job->phase) {
+        case RAINBOW_START:
+            turnLedOff();
+            job->resumeAt = millis() + 100;
+            job->phase = RAINBOW_FADE;
+            return true;
+
+        case RAINBOW_FADE:
+            if (job->cycle >= job->cycles) {
+                job->resumeAt = millis() + 200;
+                job->phase = RAINBOW_FINISH;
+                return true;
+            }
 
-        // Choose the colours to increment and decrement.
-        for (int decColour = 0; decColour < 3; decColour += 1) {
-            int incColour = decColour == 2 ? 0 : decColour + 1;
+            if (job->decColour == 0 && job->step == 0) {
+                // Start off with red.
+                job->rgbColour[0] = 255;
+                job->rgbColour[1] = 0;
+                job->rgbColour[2] = 0;
+            }
 
             // cross-fade the two colours.
-            for(int i = 0; i < 255; i += 1) {
-                rgbColour[decColour] -= 1;
-                rgbColour[incColour] += 1;
+            {
+                int incColour = job->decColour == 2 ? 0 : job->decColour + 1;
+                job->rgbColour[job->decColour] -= 1;
+                job->rgbColour[incColour] += 1;
+                setLedColor(job->rgbColour[0], job->rgbColour[1], job->rgbColour[2]);
+            }
 
-                setLedColor(rgbColour[0], rgbColour[1], rgbColour[2]);
-                delay(5);
+            if (++job->step == 255) {
+                job->step = 0;
+                if (++job->decColour == 3) {
+                    job->decColour = 0;
+                    job->cycle++;
+                }
             }
-        }
+            job->resumeAt = millis() + 5;
+            return true;
+
+        case RAINBOW_FINISH:
+            turnLedOff();
+            job->resumeAt = millis() + 100;
+            job->phase = RAINBOW_RESTORE;
+            return true;
+
+        default:
+            // return it to the status color
+            showState();
+            return false;
+    }
+}
+
+// make the RGB LED color cycle, the hub gets "accepted" with a job id and the
+// completion is reported through the methodJob reported property
+int directMethod(JsonObject& payload, char *response, size_t responseSize) {
+    if (isMethodJobRunning(rainbowJobId)) {
+        snprintf(response, responseSize, "{\"status\":\"busy\",\"jobId\":%d}", rainbowJobId);
+        return busyStatusCode;
     }
 
-    // return it to the status color
-    delay(200);
-    turnLedOff();
-    delay(100);
-    showState();
+    memset(&rainbowJob, 0, sizeof(rainbowJob));
+    rainbowJob.phase = RAINBOW_START;
+    rainbowJob.cycles = payload["cycles"];
+    rainbowJob.resumeAt = millis();
+
+    rainbowJobId = startMethodJob("rainbow", rainbowStep, &rainbowJob);
+    if (rainbowJobId < 0) {
+        snprintf(response, responseSize, "{\"status\":\"busy\"}");
+        return busyStatusCode;
+    }
+
+    snprintf(response, responseSize, "{\"status\":\"accepted\",\"jobId\":%d}", rainbowJobId);
+    return acceptedStatusCode;
+}
+
+// returns the sensor read timing histograms
+int sensorStatsMethod(JsonObject& payload, char *response, size_t responseSize) {
+    if (buildSensorStatsJson(response, responseSize) < 0) {
+        snprintf(response, responseSize, "{}");
+        return errorStatusCode;
+    }
 
-    *response = strdup(response_completed);
     return successStatusCode;
 }
 
-// this is the callback method for the fanSpeed desired property
-int fanSpeedDesiredChange(const char *message, size_t size, char **response, size_t* resp_size) {
-    animationInit(fan, 2, 64, 0, 0, true);
+// returns the run time, jitter and overrun counts of every scheduler task
+int schedulerStatsMethod(JsonObject& payload, char *response, size_t responseSize) {
+    if (buildSchedulerStatsJson(response, responseSize) < 0) {
+        snprintf(response, responseSize, "{}");
+        return errorStatusCode;
+    }
 
+    return successStatusCode;
+}
+
+// returns the message, batching and deadband counters with the reported property pool use
+int deviceStatsMethod(JsonObject& payload, char *response, size_t responseSize) {
+    char counters[256];
+    char reported[128];
+    int countersLength = buildCounterStatsJson(counters, sizeof(counters));
+    int reportedLength = buildReportedStatsJson(reported, sizeof(reported));
+
+    JSON_WRITER writer;
+    jsonWriterInit(&writer, response, responseSize);
+    jsonWriterBeginObject(&writer, NULL);
+    jsonWriterAddMembers(&writer, counters, countersLength);
+    jsonWriterAddRaw(&writer, "reportedProperties", reported);
+    jsonWriterAddInt(&writer, "callbackCollisions", getCallbackCollisions());
+    jsonWriterEndObject(&writer);
+
+    if (countersLength < 0 || reportedLength < 0 || jsonWriterOverflow(&writer)) {
+        snprintf(response, responseSize, "{}");
+        return errorStatusCode;
+    }
+
+    return successStatusCode;
+}
+
+// this is the callback method for the fanSpeed desired property
+int fanSpeedDesiredChange(JsonObject& property, char *response, size_t responseSize) {
     Serial.println("fanSpeed desired property just got called");
 
     // turn on the fan - sound
     playFanSound();
     
-    // show the animation
-    Screen.clean();
-    for(int i = 0; i < 100; i++) {
-        renderNextFrame();
-    }
+    // the animation runs from the scheduler so the callback returns straight away
+    animationStart(fan, 2, fanAnimationFrames, 0, fanFrameInterval, true);
 
     incrementDesiredCount();
 
-    *response = strdup(response_completed);
+    snprintf(response, responseSize, "%s", response_completed);
     return successStatusCode;
 }
 
-int voltageDesiredChange(const char *message, size_t size, char **response, size_t* resp_size) {
+int voltageDesiredChange(JsonObject& property, char *response, size_t responseSize) {
     Serial.println("setVoltage desired property just got called");
 
-    animationInit(voltage, 9, 64, 0, 30, true);
-
-    // show the animation
-    Screen.clean();
-    for(int i = 0; i < 54; i++) {
-        renderNextFrame();
-    }
+    animationStart(voltage, 9, levelAnimationFrames, 0, levelFrameInterval, true);
 
     incrementDesiredCount();
 
-    *response = strdup(response_completed);
+    snprintf(response, responseSize, "%s", response_completed);
     return successStatusCode;
 }
 
-int currentDesiredChange(const char *message, size_t size, char **response, size_t* resp_size) {
+int currentDesiredChange(JsonObject& property, char *response, size_t responseSize) {
     Serial.println("setCurrent desired property just got called");
 
-    animationInit(current, 9, 64, 0, 30, false);
-
-    // show the animation
-    Screen.clean();
-    for(int i = 0; i < 54; i++) {
-        renderNextFrame();
-    }
+    animationStart(current, 9, levelAnimationFrames, 0, levelFrameInterval, false);
 
     incrementDesiredCount();
 
-    *response = strdup(response_completed);
+    snprintf(response, responseSize, "%s", response_completed);
 
     return successStatusCode;
 }
 
-int irOnDesiredChange(const char *message, size_t size, char **response, size_t* resp_size) {
+int irOnDesiredChange(JsonObject& property, char *response, size_t responseSize) {
     Serial.println("activateIR desired property just got called");
 
-    Screen.clean();
-    Screen.print(0, "Firing IR beam");
-
-    transmitIR();
+    // the burst is sent a pulse at a time by the IR task
+    animationCancel();
+    displayMessage("Firing IR beam", NULL, irBurstDuration() + irHoldTime);
+    startIRBurst();
 
     incrementDesiredCount();
 
-    delay(1000);
-
-    *response = strdup(response_completed);
+    snprintf(response, responseSize, "%s", response_completed);
 
     return successStatusCode;
 }
\ No newline at end of file
@@ -0,0 +1,191 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+
+#include "../inc/reportedProperties.h"
+#include "../inc/outboundWorker.h"
+#include "../inc/jsonWriter.h"
+#include "../inc/stats.h"
+
+static MemoryPool<TWIN_PROPERTY_REPORTED, REPORTED_POOL_DEPTH> reportedPool;
+static Queue<TWIN_PROPERTY_REPORTED, REPORTED_POOL_DEPTH> queuePropertyReported;
+static Mutex reportedPoolLock;
+static int reportedPoolInUse = 0;
+static int reportedPoolHighWater = 0;
+static int reportedPoolExhausted = 0;
+
+// desired property echoes are held for a window and merged into one reported patch
+static TWIN_PROPERTY_REPORTED *pendingReported[REPORTED_POOL_DEPTH];
+static int pendingReportedCount = 0;
+static unsigned long pendingReportedSince = 0;
+static unsigned long reportedPropertyWindow = 0;
+static int reportedMessagesSaved = 0;
+
+static void releaseReportedProperty(TWIN_PROPERTY_REPORTED *propertyReported) {
+    reportedPoolLock.lock();
+    reportedPool.free(propertyReported);
+    reportedPoolInUse--;
+    reportedPoolLock.unlock();
+}
+
+static void desiredPropertyEchoed(const char *payload, int properties, bool success) {
+    if (success) {
+        Serial.printf("Desired properties %s successfully echoed back as a reported property\r\n", payload);
+        // one acknowledgement per property merged into the patch
+        for (int i = 0; i < properties; i++) {
+            incrementReportedCount();
+        }
+    } else {
+        Serial.printf("Desired properties %s failed to be echoed back as a reported property\r\n", payload);
+        incrementErrorCount();
+    }
+}
+
+static void addPendingReported(TWIN_PROPERTY_REPORTED *propertyReported) {
+    // a later value for the same property replaces the earlier one
+    for (int i = 0; i < pendingReportedCount; i++) {
+        if (strcmp(pendingReported[i]->name, propertyReported->name) == 0) {
+            releaseReportedProperty(pendingReported[i]);
+            pendingReported[i] = propertyReported;
+            reportedMessagesSaved++;
+            return;
+        }
+    }
+
+    if (pendingReportedCount == 0) {
+        pendingReportedSince = millis();
+    }
+    pendingReported[pendingReportedCount++] = propertyReported;
+}
+
+static bool addReportedMember(JSON_WRITER *writer, TWIN_PROPERTY_REPORTED *propertyReported) {
+    int mark = jsonWriterLength(writer);
+
+    jsonWriterBeginObject(writer, propertyReported->name);
+    jsonWriterAddRaw(writer, "value", propertyReported->value);
+    jsonWriterAddInt(writer, "statusCode", propertyReported->statusCode);
+    jsonWriterAddString(writer, "status", propertyReported->status);
+    jsonWriterAddInt(writer, "desiredVersion", propertyReported->version);
+    jsonWriterEndObject(writer);
+
+    // leave room for the closing brace of the patch
+    if (jsonWriterOverflow(writer) || jsonWriterLength(writer) + 2 > OUTBOUND_PAYLOAD_MAX) {
+        jsonWriterTruncate(writer, mark);
+        return false;
+    }
+    return true;
+}
+
+// sends the pending echoes as few patches as fit in an outbound message
+static void flushPendingReported() {
+    char patch[OUTBOUND_PAYLOAD_MAX];
+    JSON_WRITER writer;
+    int next = 0;
+
+    while (next < pendingReportedCount) {
+        int properties = 0;
+        jsonWriterInit(&writer, patch, sizeof(patch));
+        jsonWriterBeginObject(&writer, NULL);
+        while (next < pendingReportedCount && addReportedMember(&writer, pendingReported[next])) {
+            properties++;
+            next++;
+        }
+
+        if (properties == 0) {
+            Serial.printf("Desired property %s is too large to be echoed back as a reported property\r\n", pendingReported[next]->name);
+            incrementErrorCount();
+            next++;
+            continue;
+        }
+
+        jsonWriterEndObject(&writer);
+        if (queueReportedProperty(patch, properties, desiredPropertyEchoed)) {
+            reportedMessagesSaved += properties - 1;
+        } else {
+            Serial.printf("Desired properties %s could not be queued to be echoed back as a reported property\r\n", patch);
+            incrementErrorCount();
+        }
+    }
+
+    for (int i = 0; i < pendingReportedCount; i++) {
+        releaseReportedProperty(pendingReported[i]);
+    }
+    pendingReportedCount = 0;
+}
+
+// every desired property change gets echoed back as a reported property
+void echoDesiredProperty(void) {
+    while (pendingReportedCount < REPORTED_POOL_DEPTH) {
+        osEvent evt = queuePropertyReported.get(0);
+        if (evt.status != osEventMessage) {
+            break;
+        }
+        addPendingReported((TWIN_PROPERTY_REPORTED*)evt.value.p);
+    }
+
+    if (pendingReportedCount > 0 &&
+        (pendingReportedCount == REPORTED_POOL_DEPTH || millis() - pendingReportedSince >= reportedPropertyWindow)) {
+        flushPendingReported();
+    }
+}
+
+// a window of 0 sends whatever was collected on each call of echoDesiredProperty
+void setReportedPropertyWindow(unsigned long window) {
+    reportedPropertyWindow = window;
+}
+
+int getReportedMessagesSaved() {
+    return reportedMessagesSaved;
+}
+
+// queues the echo of a desired property, it is sent with the next patch
+void reportDesiredProperty(const char *propertyName, const char *value, int version, const char *status, int statusCode) {
+    reportedPoolLock.lock();
+    TWIN_PROPERTY_REPORTED *propertyReported = reportedPool.alloc();
+    if (propertyReported == NULL) {
+        reportedPoolExhausted++;
+    } else if (++reportedPoolInUse > reportedPoolHighWater) {
+        reportedPoolHighWater = reportedPoolInUse;
+    }
+    reportedPoolLock.unlock();
+
+    if (propertyReported == NULL) {
+        Serial.printf("Desired property %s dropped, reported property pool exhausted\r\n", propertyName);
+        incrementErrorCount();
+        return;
+    }
+
+    snprintf(propertyReported->name, REPORTED_NAME_MAX, "%s", propertyName);
+    snprintf(propertyReported->value, REPORTED_VALUE_MAX, "%s", value);
+    propertyReported->version = version;
+    snprintf(propertyReported->status, REPORTED_STATUS_MAX, "%s", status);
+    propertyReported->statusCode = statusCode;
+
+    if (queuePropertyReported.put(propertyReported) != osOK) {
+        releaseReportedProperty(propertyReported);
+        incrementErrorCount();
+    }
+}
+
+int getReportedPoolHighWater() {
+    return reportedPoolHighWater;
+}
+
+int getReportedPoolExhausted() {
+    return reportedPoolExhausted;
+}
+
+// pool use for the getDeviceStats method, -1 if it does not fit
+int buildReportedStatsJson(char *buffer, int size) {
+    JSON_WRITER writer;
+    jsonWriterInit(&writer, buffer, size);
+    jsonWriterBeginObject(&writer, NULL);
+    jsonWriterAddInt(&writer, "poolDepth", REPORTED_POOL_DEPTH);
+    jsonWriterAddInt(&writer, "poolHighWater", reportedPoolHighWater);
+    jsonWriterAddInt(&writer, "poolExhausted", reportedPoolExhausted);
+    jsonWriterAddInt(&writer, "messagesSaved", reportedMessagesSaved);
+    jsonWriterEndObject(&writer);
+    return jsonWriterOverflow(&writer) ? -1 : jsonWriterLength(&writer);
+}
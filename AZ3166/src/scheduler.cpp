@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/scheduler.h"
+#include "../inc/jsonWriter.h"
+
+typedef struct TASK_TAG {
+    taskCallback callback;
+    unsigned long deadline;
+    bool ran;
+    TASK_STATS stats;
+} TASK;
+
+static TASK tasks[SCHEDULER_MAX_TASKS];
+static int taskCount = 0;
+static schedulerClock clockSource = NULL;
+
+static bool isDue(unsigned long now, unsigned long deadline) {
+    return (long)(now - deadline) >= 0;
+}
+
+// the clock is passed in so the scheduler can be driven by a simulated time source
+void schedulerInit(schedulerClock clock) {
+    clockSource = clock;
+    taskCount = 0;
+}
+
+int schedulerAddTask(const char *name, taskCallback callback, unsigned long period) {
+    if (taskCount >= SCHEDULER_MAX_TASKS || clockSource == NULL) {
+        return -1;
+    }
+
+    TASK *task = &tasks[taskCount];
+    memset(task, 0, sizeof(TASK));
+    task->callback = callback;
+    task->deadline = clockSource() + period;
+    task->stats.name = name;
+    task->stats.period = period;
+
+    return taskCount++;
+}
+
+void schedulerSetPeriod(int taskId, unsigned long period) {
+    if (taskId < 0 || taskId >= taskCount) {
+        return;
+    }
+
+    // move the pending deadline so a shorter period takes effect straight away
+    tasks[taskId].deadline = tasks[taskId].deadline - tasks[taskId].stats.period + period;
+    tasks[taskId].stats.period = period;
+}
+
+// runs every task that is due once, earliest deadline first
+void schedulerRun() {
+    if (clockSource == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < taskCount; i++) {
+        tasks[i].ran = false;
+    }
+
+    while (true) {
+        unsigned long now = clockSource();
+        TASK *next = NULL;
+        for (int i = 0; i < taskCount; i++) {
+            if (!tasks[i].ran && isDue(now, tasks[i].deadline) &&
+                (next == NULL || (long)(tasks[i].deadline - next->deadline) < 0)) {
+                next = &tasks[i];
+            }
+        }
+        if (next == NULL) {
+            break;
+        }
+
+        unsigned long jitter = now - next->deadline;
+        next->callback();
+        unsigned long runTime = clockSource() - now;
+
+        next->ran = true;
+        next->stats.runs++;
+        next->stats.totalRunTime += runTime;
+        if (jitter > next->stats.maxJitter) {
+            next->stats.maxJitter = jitter;
+        }
+        if (runTime > next->stats.maxRunTime) {
+            next->stats.maxRunTime = runTime;
+        }
+
+        // a task that ran past its period or missed a whole period is an overrun,
+        // it is rescheduled from now instead of trying to catch up, period 0 runs every pass
+        next->deadline += next->stats.period;
+        if (next->stats.period > 0 && (runTime > next->stats.period || isDue(now, next->deadline))) {
+            next->stats.overruns++;
+            next->deadline = clockSource() + next->stats.period;
+        }
+    }
+}
+
+int schedulerTaskCount() {
+    return taskCount;
+}
+
+bool schedulerGetStats(int taskId, TASK_STATS *stats) {
+    if (taskId < 0 || taskId >= taskCount) {
+        return false;
+    }
+    *stats = tasks[taskId].stats;
+    return true;
+}
+
+void schedulerClearStats() {
+    for (int i = 0; i < taskCount; i++) {
+        tasks[i].stats.runs = 0;
+        tasks[i].stats.maxJitter = 0;
+        tasks[i].stats.maxRunTime = 0;
+        tasks[i].stats.totalRunTime = 0;
+        tasks[i].stats.overruns = 0;
+    }
+}
+
+// one array per task keyed by the task name, in the order listed under "fields" so the
+// stats of every task fit a method response, times are in milliseconds
+int buildSchedulerStatsJson(char *buffer, int size) {
+    static const char *fields[] = { "period", "runs", "avgRun", "maxRun", "maxJitter", "overruns" };
+    JSON_WRITER writer;
+    jsonWriterInit(&writer, buffer, size);
+    jsonWriterBeginObject(&writer, NULL);
+
+    jsonWriterBeginArray(&writer, "fields");
+    for (int i = 0; i < (int)(sizeof(fields) / sizeof(fields[0])); i++) {
+        jsonWriterAddString(&writer, NULL, fields[i]);
+    }
+    jsonWriterEndArray(&writer);
+
+    for (int i = 0; i < taskCount; i++) {
+        TASK_STATS *stats = &tasks[i].stats;
+        jsonWriterBeginArray(&writer, stats->name);
+        jsonWriterAddUnsigned(&writer, NULL, stats->period);
+        jsonWriterAddUnsigned(&writer, NULL, stats->runs);
+        jsonWriterAddUnsigned(&writer, NULL, stats->runs > 0 ? stats->totalRunTime / stats->runs : 0);
+        jsonWriterAddUnsigned(&writer, NULL, stats->maxRunTime);
+        jsonWriterAddUnsigned(&writer, NULL, stats->maxJitter);
+        jsonWriterAddUnsigned(&writer, NULL, stats->overruns);
+        jsonWriterEndArray(&writer);
+    }
+
+    jsonWriterEndObject(&writer);
+    return jsonWriterOverflow(&writer) ? -1 : jsonWriterLength(&writer);
+}
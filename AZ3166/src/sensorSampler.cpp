@@ -0,0 +1,149 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/sensorSampler.h"
+#include "../inc/sensors.h"
+#include "../inc/config.h"
+
+// error value returned by the sensor readers
+#define SENSOR_ERROR_VALUE 0xFFFF
+
+static const SENSOR_CHANNEL channels[CHANNEL_COUNT] = {
+    { "humidity", HUMIDITY_CHECKED, false },
+    { "temp", TEMP_CHECKED, false },
+    { "pressure", PRESSURE_CHECKED, false },
+    { "magnetometerX", MAG_CHECKED, true },
+    { "magnetometerY", MAG_CHECKED, true },
+    { "magnetometerZ", MAG_CHECKED, true },
+    { "accelerometerX", ACCEL_CHECKED, true },
+    { "accelerometerY", ACCEL_CHECKED, true },
+    { "accelerometerZ", ACCEL_CHECKED, true },
+    { "gyroscopeX", GYRO_CHECKED, true },
+    { "gyroscopeY", GYRO_CHECKED, true },
+    { "gyroscopeZ", GYRO_CHECKED, true }
+};
+
+static CHANNEL_AGGREGATE aggregates[CHANNEL_COUNT];
+
+// read time of the HTS221 conversion last added to the window
+static unsigned long hts221SampleTime = 0;
+
+const SENSOR_CHANNEL *getSensorChannel(int channel) {
+    if (channel < 0 || channel >= CHANNEL_COUNT) {
+        return NULL;
+    }
+    return &channels[channel];
+}
+
+static void addAxes(int firstChannel, const int *axes) {
+    for (int i = 0; i < 3; i++) {
+        addSample(firstChannel + i, axes[i]);
+    }
+}
+
+// every sample buffered by the LSM6DSL FIFO since the last call goes into the window
+static void sampleMotionFifo(uint8_t sensorMask) {
+    MOTION_SAMPLE sample;
+
+    drainMotionFifo();
+    while (takeMotionSample(&sample)) {
+        if ((sensorMask & ACCEL_CHECKED) == ACCEL_CHECKED) {
+            addAxes(CHANNEL_ACCEL_X, sample.accel);
+        }
+        if ((sensorMask & GYRO_CHECKED) == GYRO_CHECKED) {
+            addAxes(CHANNEL_GYRO_X, sample.gyro);
+        }
+    }
+}
+
+// the HTS221 converts once a second and is read from a cache in between, so a reading is
+// only added when it is new or the window would otherwise have none
+static void sampleHumidityTemperature(int channel, float value) {
+    if (getHumidityTemperatureTime() != hts221SampleTime || aggregates[channel].count == 0) {
+        addSample(channel, value);
+    }
+}
+
+// reads every enabled sensor once and folds the readings into the window aggregates
+void sampleSensors(uint8_t sensorMask) {
+    // HTS221
+    if ((sensorMask & HUMIDITY_CHECKED) == HUMIDITY_CHECKED) {
+        sampleHumidityTemperature(CHANNEL_HUMIDITY, readHumidity());
+    }
+    if ((sensorMask & TEMP_CHECKED) == TEMP_CHECKED) {
+        sampleHumidityTemperature(CHANNEL_TEMP, readTemperature());
+    }
+    hts221SampleTime = getHumidityTemperatureTime();
+
+    // LPS22HB
+    if ((sensorMask & PRESSURE_CHECKED) == PRESSURE_CHECKED) {
+        addSample(CHANNEL_PRESSURE, readPressure());
+    }
+
+    // LIS2MDL
+    int axes[3];
+    if ((sensorMask & MAG_CHECKED) == MAG_CHECKED) {
+        readMagnetometer(axes);
+        addAxes(CHANNEL_MAG_X, axes);
+    }
+
+    // LSM6DSL
+    if (isMotionFifoEnabled()) {
+        sampleMotionFifo(sensorMask);
+        return;
+    }
+    if ((sensorMask & ACCEL_CHECKED) == ACCEL_CHECKED) {
+        readAccelerometer(axes);
+        addAxes(CHANNEL_ACCEL_X, axes);
+    }
+    if ((sensorMask & GYRO_CHECKED) == GYRO_CHECKED) {
+        readGyroscope(axes);
+        addAxes(CHANNEL_GYRO_X, axes);
+    }
+}
+
+// Welford's online mean/variance, failed reads are left out of the window
+void addSample(int channel, float value) {
+    if (channel < 0 || channel >= CHANNEL_COUNT || value == SENSOR_ERROR_VALUE) {
+        return;
+    }
+
+    CHANNEL_AGGREGATE *aggregate = &aggregates[channel];
+    aggregate->count++;
+    if (aggregate->count == 1) {
+        aggregate->mean = value;
+        aggregate->m2 = 0;
+        aggregate->min = value;
+        aggregate->max = value;
+        return;
+    }
+
+    float delta = value - aggregate->mean;
+    aggregate->mean += delta / aggregate->count;
+    aggregate->m2 += delta * (value - aggregate->mean);
+    if (value < aggregate->min) {
+        aggregate->min = value;
+    }
+    if (value > aggregate->max) {
+        aggregate->max = value;
+    }
+}
+
+// copies out the current window and starts a new one
+void takeAggregates(CHANNEL_AGGREGATE *window) {
+    memcpy(window, aggregates, sizeof(aggregates));
+    clearAggregates();
+}
+
+void clearAggregates() {
+    memset(aggregates, 0, sizeof(aggregates));
+}
+
+float aggregateStdDev(const CHANNEL_AGGREGATE *aggregate) {
+    if (aggregate->count < 2) {
+        return 0;
+    }
+    return sqrt(aggregate->m2 / aggregate->count);
+}
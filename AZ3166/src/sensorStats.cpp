@@ -0,0 +1,176 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+
+#include "../inc/sensorStats.h"
+#include "../inc/sensors.h"
+#include "../inc/jsonWriter.h"
+#include "../inc/displayCache.h"
+
+static const char *readerNames[SENSOR_READ_COUNT] = {
+    "humidity",
+    "temp",
+    "pressure",
+    "magnetometer",
+    "accelerometer",
+    "gyroscope",
+    "motionFifo"
+};
+
+static SENSOR_TIMING timings[SENSOR_READ_COUNT];
+
+#if defined(__arm__)
+// the DWT cycle counter gives cycle accurate timing on the Cortex-M4
+static uint32_t cyclesPerMicro = 1;
+
+void initSensorTiming() {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cyclesPerMicro = SystemCoreClock / 1000000;
+    clearSensorTiming();
+}
+
+uint32_t sensorTimerStart() {
+    return DWT->CYCCNT;
+}
+
+static unsigned long elapsedMicros(uint32_t start) {
+    return (DWT->CYCCNT - start) / cyclesPerMicro;
+}
+#else
+// host builds time the reads with the Arduino clock
+void initSensorTiming() {
+    clearSensorTiming();
+}
+
+uint32_t sensorTimerStart() {
+    return (uint32_t)micros();
+}
+
+static unsigned long elapsedMicros(uint32_t start) {
+    return (uint32_t)(sensorTimerStart() - start);
+}
+#endif
+
+void sensorTimerStop(int reader, uint32_t start, bool error) {
+    unsigned long micros = elapsedMicros(start);
+    if (reader < 0 || reader >= SENSOR_READ_COUNT) {
+        return;
+    }
+
+    SENSOR_TIMING *timing = &timings[reader];
+    if (error) {
+        // failed reads are kept out of the latency figures
+        timing->errors++;
+        return;
+    }
+
+    int bucket = 0;
+    while (bucket < SENSOR_HISTOGRAM_BUCKETS - 1 && (micros >> (bucket + 1)) != 0) {
+        bucket++;
+    }
+
+    timing->count++;
+    timing->totalMicros += micros;
+    timing->histogram[bucket]++;
+    if (micros > timing->maxMicros) {
+        timing->maxMicros = micros;
+    }
+}
+
+const char *getSensorReadName(int reader) {
+    if (reader < 0 || reader >= SENSOR_READ_COUNT) {
+        return NULL;
+    }
+    return readerNames[reader];
+}
+
+bool getSensorTiming(int reader, SENSOR_TIMING *timing) {
+    if (reader < 0 || reader >= SENSOR_READ_COUNT) {
+        return false;
+    }
+    *timing = timings[reader];
+    return true;
+}
+
+void clearSensorTiming() {
+    memset(timings, 0, sizeof(timings));
+}
+
+static void addSensorStats(JSON_WRITER *writer, bool histograms) {
+    jsonWriterBeginObject(writer, NULL);
+
+    for (int i = 0; i < SENSOR_READ_COUNT; i++) {
+        SENSOR_TIMING *timing = &timings[i];
+        if (timing->count == 0 && timing->errors == 0) {
+            continue;
+        }
+
+        jsonWriterBeginObject(writer, readerNames[i]);
+        jsonWriterAddUnsigned(writer, "count", timing->count);
+        jsonWriterAddUnsigned(writer, "errors", timing->errors);
+        jsonWriterAddUnsigned(writer, "avgUs", timing->count > 0 ? timing->totalMicros / timing->count : 0);
+        jsonWriterAddUnsigned(writer, "maxUs", timing->maxMicros);
+        if (histograms) {
+            jsonWriterBeginArray(writer, "histogram");
+            for (int bucket = 0; bucket < SENSOR_HISTOGRAM_BUCKETS; bucket++) {
+                jsonWriterAddUnsigned(writer, NULL, timing->histogram[bucket]);
+            }
+            jsonWriterEndArray(writer);
+        }
+        jsonWriterEndObject(writer);
+    }
+
+    // the throughput of the FIFO capture and what it costs on the bus
+    if (isMotionFifoEnabled()) {
+        jsonWriterBeginObject(writer, "motionCapture");
+        jsonWriterAddFloat(writer, "samplesPerSec", getMotionSamplesPerSecond());
+        jsonWriterAddFloat(writer, "i2cBytesPerSample", getMotionI2cBytesPerSample());
+        jsonWriterEndObject(writer);
+    }
+
+    jsonWriterEndObject(writer);
+}
+
+// once the counters grow long the histograms of every reader no longer fit a method
+// response, they are left out then and the rest always fits
+int buildSensorStatsJson(char *buffer, int size) {
+    JSON_WRITER writer;
+    jsonWriterInit(&writer, buffer, size);
+    addSensorStats(&writer, true);
+    if (jsonWriterOverflow(&writer)) {
+        jsonWriterInit(&writer, buffer, size);
+        addSensorStats(&writer, false);
+    }
+    return jsonWriterOverflow(&writer) ? -1 : jsonWriterLength(&writer);
+}
+
+static void chipTiming(int first, int last, unsigned long *maxMicros, unsigned long *errors) {
+    *maxMicros = 0;
+    *errors = 0;
+    for (int i = first; i <= last; i++) {
+        if (timings[i].maxMicros > *maxMicros) {
+            *maxMicros = timings[i].maxMicros;
+        }
+        *errors += timings[i].errors;
+    }
+}
+
+// debug page with the slowest read and the error count of each sensor chip
+void displaySensorInfo() {
+    char buff[80];
+    unsigned long hts, lps, mag, lsm;
+    unsigned long htsErrors, lpsErrors, magErrors, lsmErrors;
+
+    chipTiming(SENSOR_READ_HUMIDITY, SENSOR_READ_TEMPERATURE, &hts, &htsErrors);
+    chipTiming(SENSOR_READ_PRESSURE, SENSOR_READ_PRESSURE, &lps, &lpsErrors);
+    chipTiming(SENSOR_READ_MAGNETOMETER, SENSOR_READ_MAGNETOMETER, &mag, &magErrors);
+    chipTiming(SENSOR_READ_ACCELEROMETER, SENSOR_READ_MOTION_FIFO, &lsm, &lsmErrors);
+
+    sprintf(buff, "hts%6luus e%lu\r\nlps%6luus e%lu\r\nmag%6luus e%lu\r\nlsm%6luus e%lu",
+        hts, htsErrors, lps, lpsErrors, mag, magErrors, lsm, lsmErrors);
+    displayPrint(0, buff);
+}
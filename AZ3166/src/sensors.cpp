@@ -11,6 +11,7 @@
 #include "IrDASensor.h"
 
 #include "../inc/sensors.h"
+#include "../inc/sensorStats.h"
 
 DevI2C *i2c;
 LSM6DSLSensor *accelGyro;
@@ -20,7 +21,46 @@ LPS22HBSensor *pressure;
 RGB_LED rgbLed;
 IRDASensor *irdaSensor;
 
+#define HTS221_CONVERSION_PERIOD 1000
+
+static float hts221Humidity;
+static float hts221Temperature;
+static unsigned long hts221ReadTime;
+static bool hts221Valid = false;
+
+// LSM6DSL FIFO registers
+#define LSM6DSL_REG_FIFO_CTRL1      0x06
+#define LSM6DSL_REG_FIFO_CTRL2      0x07
+#define LSM6DSL_REG_FIFO_CTRL3      0x08
+#define LSM6DSL_REG_FIFO_CTRL5      0x0A
+#define LSM6DSL_REG_FIFO_STATUS1    0x3A
+#define LSM6DSL_REG_FIFO_DATA_OUT_L 0x3E
+
+#define LSM6DSL_FIFO_MODE_BYPASS     0x00
+#define LSM6DSL_FIFO_MODE_CONTINUOUS 0x06
+#define LSM6DSL_FIFO_NO_DECIMATION   0x09    // gyroscope and accelerometer both in the FIFO
+#define LSM6DSL_FIFO_WATERMARK       0x80
+#define LSM6DSL_FIFO_OVERRUN         0x40
+
+#define MOTION_WORDS_PER_SAMPLE 6            // gyroscope x,y,z then accelerometer x,y,z
+#define MOTION_BYTES_PER_SAMPLE (MOTION_WORDS_PER_SAMPLE * 2)
+#define MOTION_SAMPLES_PER_READ 16
+#define MOTION_WATERMARK_WORDS  (MOTION_SAMPLES_PER_READ * MOTION_WORDS_PER_SAMPLE)
+#define MOTION_RING_SIZE        128
+
+static bool motionFifoEnabled = false;
+static float accelSensitivity;
+static float gyroSensitivity;
+static uint8_t fifoBuffer[MOTION_SAMPLES_PER_READ * MOTION_BYTES_PER_SAMPLE];
+static MOTION_SAMPLE motionRing[MOTION_RING_SIZE];
+static int motionHead = 0;
+static int motionCount = 0;
+static unsigned long motionSamples = 0;
+static unsigned long motionI2cBytes = 0;
+static unsigned long motionStartTime = 0;
+
 void initSensors() {
+    initSensorTiming();
 
     // LSM6DSL
     i2c = new DevI2C(D14, D15);
@@ -37,9 +77,11 @@ void initSensors() {
     magnetometer = new LIS2MDLSensor(*i2c);
     magnetometer->init(NULL);
 
-    // HTS221
+    // HTS221 - converting continuously at 1Hz
     tempHumidity = new HTS221Sensor(*i2c);
     tempHumidity->init(NULL);
+    tempHumidity->enable();
+    hts221Valid = false;
 
     // LPS22HB
     pressure = new LPS22HBSensor(*i2c);
@@ -52,28 +94,51 @@ void initSensors() {
 }
 
 // HTS221
+// humidity and temperature come from the same conversion, so both are read together and
+// cached until the next conversion is due instead of resetting the chip for every read
+static void readHumidityTemperature() {
+    if (hts221Valid && millis() - hts221ReadTime < HTS221_CONVERSION_PERIOD) {
+        return;
+    }
+
+    hts221Valid = (tempHumidity->getHumidity(&hts221Humidity) == 0 && tempHumidity->getTemperature(&hts221Temperature) == 0);
+    if (hts221Valid) {
+        hts221ReadTime = millis();
+    }
+}
+
 float readHumidity() {
-    float humidityValue;
-    tempHumidity->reset();
-    if (tempHumidity->getHumidity(&humidityValue) == 0)
-        return humidityValue;
+    uint32_t start = sensorTimerStart();
+    readHumidityTemperature();
+    sensorTimerStop(SENSOR_READ_HUMIDITY, start, !hts221Valid);
+    if (hts221Valid)
+        return hts221Humidity;
     else
         return 0xFFFF;
 }
 
 float readTemperature() {
-    float tempValue;
-    tempHumidity->reset();
-    if (tempHumidity->getTemperature(&tempValue) == 0)
-        return tempValue;
+    uint32_t start = sensorTimerStart();
+    readHumidityTemperature();
+    sensorTimerStop(SENSOR_READ_TEMPERATURE, start, !hts221Valid);
+    if (hts221Valid)
+        return hts221Temperature;
     else
         return 0xFFFF;
 }
 
+// when the cached humidity and temperature were read from the chip
+unsigned long getHumidityTemperatureTime() {
+    return hts221ReadTime;
+}
+
 // LPS22HB
 float readPressure() {
     float presureValue;
-    if (pressure->getPressure(&presureValue) == 0)
+    uint32_t start = sensorTimerStart();
+    int status = pressure->getPressure(&presureValue);
+    sensorTimerStop(SENSOR_READ_PRESSURE, start, status != 0);
+    if (status == 0)
         return presureValue;
     else
         return 0xFFFF;
@@ -81,7 +146,10 @@ float readPressure() {
 
 // LIS2MDL
 void readMagnetometer(int *axes) {
-    if (magnetometer->getMAxes(axes) != 0) {
+    uint32_t start = sensorTimerStart();
+    int status = magnetometer->getMAxes(axes);
+    sensorTimerStop(SENSOR_READ_MAGNETOMETER, start, status != 0);
+    if (status != 0) {
         axes[0] = 0xFFFF;
         axes[1] = 0xFFFF;
         axes[2] = 0xFFFF;
@@ -90,7 +158,10 @@ void readMagnetometer(int *axes) {
 
 // LSM6DSL
 void readAccelerometer(int *axes) {
-    if (accelGyro->getXAxes(axes) != 0) {
+    uint32_t start = sensorTimerStart();
+    int status = accelGyro->getXAxes(axes);
+    sensorTimerStop(SENSOR_READ_ACCELEROMETER, start, status != 0);
+    if (status != 0) {
         axes[0] = 0xFFFF;
         axes[1] = 0xFFFF;
         axes[2] = 0xFFFF;
@@ -98,7 +169,10 @@ void readAccelerometer(int *axes) {
 }
 
 void readGyroscope(int *axes) {
-    if (accelGyro->getGAxes(axes) != 0) {
+    uint32_t start = sensorTimerStart();
+    int status = accelGyro->getGAxes(axes);
+    sensorTimerStop(SENSOR_READ_GYROSCOPE, start, status != 0);
+    if (status != 0) {
         axes[0] = 0xFFFF;
         axes[1] = 0xFFFF;
         axes[2] = 0xFFFF;
@@ -117,6 +191,156 @@ bool checkForShake() {
     return shake;
 }
 
+// LSM6DSL FIFO capture
+// the chip buffers samples at the configured rate and they are fetched in bulk reads
+// instead of one getXAxes/getGAxes transaction per reading
+static int fifoWriteReg(uint8_t reg, uint8_t value) {
+    motionI2cBytes += 2;
+    return i2c->i2c_write(&value, LSM6DSL_ACC_GYRO_I2C_ADDRESS_HIGH, reg, 1);
+}
+
+static int fifoReadRegs(uint8_t reg, uint8_t *data, uint16_t length) {
+    motionI2cBytes += length + 1;
+    return i2c->i2c_read(data, LSM6DSL_ACC_GYRO_I2C_ADDRESS_HIGH, reg, length);
+}
+
+static uint8_t fifoOdrBits(int odr) {
+    static const int rates[] = { 13, 26, 52, 104, 208, 416, 833, 1660, 3330, 6660 };
+    for (uint8_t i = 0; i < sizeof(rates) / sizeof(rates[0]); i++) {
+        if (odr <= rates[i]) {
+            return i + 1;
+        }
+    }
+    return 10;
+}
+
+bool enableMotionFifo(int odr) {
+    if (accelGyro->setXOdr(odr) != 0 || accelGyro->setGOdr(odr) != 0 ||
+        accelGyro->getXSensitivity(&accelSensitivity) != 0 || accelGyro->getGSensitivity(&gyroSensitivity) != 0) {
+        return false;
+    }
+
+    // going through bypass mode empties the FIFO, the watermark is one bulk read
+    if (fifoWriteReg(LSM6DSL_REG_FIFO_CTRL5, LSM6DSL_FIFO_MODE_BYPASS) != 0 ||
+        fifoWriteReg(LSM6DSL_REG_FIFO_CTRL1, MOTION_WATERMARK_WORDS & 0xFF) != 0 ||
+        fifoWriteReg(LSM6DSL_REG_FIFO_CTRL2, (MOTION_WATERMARK_WORDS >> 8) & 0x07) != 0 ||
+        fifoWriteReg(LSM6DSL_REG_FIFO_CTRL3, LSM6DSL_FIFO_NO_DECIMATION) != 0 ||
+        fifoWriteReg(LSM6DSL_REG_FIFO_CTRL5, (fifoOdrBits(odr) << 3) | LSM6DSL_FIFO_MODE_CONTINUOUS) != 0) {
+        return false;
+    }
+
+    motionHead = 0;
+    motionCount = 0;
+    motionSamples = 0;
+    motionI2cBytes = 0;
+    motionStartTime = millis();
+    motionFifoEnabled = true;
+    return true;
+}
+
+void disableMotionFifo() {
+    fifoWriteReg(LSM6DSL_REG_FIFO_CTRL5, LSM6DSL_FIFO_MODE_BYPASS);
+    motionFifoEnabled = false;
+}
+
+bool isMotionFifoEnabled() {
+    return motionFifoEnabled;
+}
+
+static int16_t fifoWord(const uint8_t *data, int word) {
+    return (int16_t)(data[word * 2] | (data[word * 2 + 1] << 8));
+}
+
+static void pushMotionSample(const uint8_t *data) {
+    MOTION_SAMPLE *sample;
+    if (motionCount == MOTION_RING_SIZE) {
+        // keep the newest samples when nobody took the old ones
+        sample = &motionRing[motionHead];
+        motionHead = (motionHead + 1) % MOTION_RING_SIZE;
+    } else {
+        sample = &motionRing[(motionHead + motionCount) % MOTION_RING_SIZE];
+        motionCount++;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        sample->gyro[i] = (int)(fifoWord(data, i) * gyroSensitivity);
+        sample->accel[i] = (int)(fifoWord(data, i + 3) * accelSensitivity);
+    }
+}
+
+// moves everything the chip has buffered into the sample ring, returns the number of samples read
+int drainMotionFifo() {
+    if (!motionFifoEnabled) {
+        return 0;
+    }
+
+    // FIFO_STATUS1..4 hold the unread word count, the watermark and overrun flags and the
+    // next word in the pattern
+    uint8_t status[4];
+    uint32_t start = sensorTimerStart();
+    if (fifoReadRegs(LSM6DSL_REG_FIFO_STATUS1, status, sizeof(status)) != 0) {
+        sensorTimerStop(SENSOR_READ_MOTION_FIFO, start, true);
+        return 0;
+    }
+    int words = ((status[1] & 0x07) << 8) | status[0];
+    int pattern = ((status[3] & 0x03) << 8) | status[2];
+    if ((status[1] & LSM6DSL_FIFO_OVERRUN) != 0) {
+        Serial.println("LSM6DSL FIFO overrun, samples were lost");
+    }
+
+    // drop a partial sample so the reads stay aligned on gyroscope x
+    if (pattern != 0 && words >= MOTION_WORDS_PER_SAMPLE - pattern) {
+        int skip = MOTION_WORDS_PER_SAMPLE - pattern;
+        fifoReadRegs(LSM6DSL_REG_FIFO_DATA_OUT_L, fifoBuffer, skip * 2);
+        words -= skip;
+    }
+
+    // past the watermark the reads are whole watermarks, only the last one is shorter
+    int drained = 0;
+    int available = words / MOTION_WORDS_PER_SAMPLE;
+    while (available > 0) {
+        int samples = (available < MOTION_SAMPLES_PER_READ) ? available : MOTION_SAMPLES_PER_READ;
+        if (fifoReadRegs(LSM6DSL_REG_FIFO_DATA_OUT_L, fifoBuffer, samples * MOTION_BYTES_PER_SAMPLE) != 0) {
+            break;
+        }
+        for (int i = 0; i < samples; i++) {
+            pushMotionSample(fifoBuffer + i * MOTION_BYTES_PER_SAMPLE);
+        }
+        available -= samples;
+        drained += samples;
+    }
+
+    sensorTimerStop(SENSOR_READ_MOTION_FIFO, start, false);
+
+    motionSamples += drained;
+    return drained;
+}
+
+bool takeMotionSample(MOTION_SAMPLE *sample) {
+    if (motionCount == 0) {
+        return false;
+    }
+    *sample = motionRing[motionHead];
+    motionHead = (motionHead + 1) % MOTION_RING_SIZE;
+    motionCount--;
+    return true;
+}
+
+float getMotionSamplesPerSecond() {
+    unsigned long elapsed = millis() - motionStartTime;
+    if (!motionFifoEnabled || elapsed == 0) {
+        return 0;
+    }
+    return motionSamples * 1000.0f / elapsed;
+}
+
+float getMotionI2cBytesPerSample() {
+    if (motionSamples == 0) {
+        return 0;
+    }
+    return (float)motionI2cBytes / motionSamples;
+}
+
 // RGB LED
 void setLedColor(uint8_t red, uint8_t green, uint8_t blue) {
     rgbLed.setColor(red, green, blue);
@@ -126,16 +350,33 @@ void turnLedOff() {
     rgbLed.turnOff();
 }
 
-void transmitIR() {
-    //static unsigned char data[] = { 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01 };
-    
+// the IR burst goes out one pulse per due tick of irBurstTask so the loop keeps running
+static const int irPulseCount = 20;
+static const unsigned long irPulseInterval = 150;
+static int irPulsesLeft = 0;
+static unsigned long irNextPulse = 0;
+
+// a burst already firing starts over
+void startIRBurst() {
+    irPulsesLeft = irPulseCount;
+    irNextPulse = millis();
+}
+
+unsigned long irBurstDuration() {
+    return irPulseCount * irPulseInterval;
+}
+
+void irBurstTask() {
+    if (irPulsesLeft == 0 || (long)(millis() - irNextPulse) < 0) {
+        return;
+    }
+
     unsigned char data = 1;
-    for (int i = 0; i < 20; i++) {
-        int irda_status = irdaSensor->IRDATransmit(&data, 1, 100);
-        if(irda_status != 0)
-        {
-            Serial.println("Unable to transmit through IrDA");
-        }
-        delay(150);
+    int irda_status = irdaSensor->IRDATransmit(&data, 1, 100);
+    if(irda_status != 0)
+    {
+        Serial.println("Unable to transmit through IrDA");
     }
+    irPulsesLeft--;
+    irNextPulse += irPulseInterval;
 }
\ No newline at end of file
@@ -1,16 +1,35 @@
 // Copyright (c) Microsoft. All rights reserved.
 // Licensed under the MIT license. 
 
+#include "Arduino.h"
+
+#include "../inc/stats.h"
+#include "../inc/jsonWriter.h"
+
 static int telemetryCount;
 static int reportedCount;
 static int desiredCount;
 static int errorCount;
+static int droppedCount;
+static long batchedSamples;
+static long batchBytesSaved;
+static unsigned long maxLoopTime;
+static int backpressureCount;
+static long channelsSent;
+static long channelsSuppressed;
 
 void clearCounters() {
     telemetryCount = 0;
     reportedCount = 0;
     desiredCount = 0;
     errorCount = 0;  
+    droppedCount = 0;
+    batchedSamples = 0;
+    batchBytesSaved = 0;
+    maxLoopTime = 0;
+    backpressureCount = 0;
+    channelsSent = 0;
+    channelsSuppressed = 0;
 }
 
 void incrementReportedCount() {
@@ -37,6 +56,30 @@ void incrementDesiredCount() {
     desiredCount++;
 }
 
+void incrementDroppedCount() {
+    droppedCount++;
+}
+
+void addBatchSavings(int samples, int bytesSaved) {
+    batchedSamples += samples;
+    batchBytesSaved += bytesSaved;
+}
+
+void recordLoopTime(unsigned long elapsed) {
+    if (elapsed > maxLoopTime) {
+        maxLoopTime = elapsed;
+    }
+}
+
+void incrementBackpressureCount() {
+    backpressureCount++;
+}
+
+void addChannelReports(int sent, int suppressed) {
+    channelsSent += sent;
+    channelsSuppressed += suppressed;
+}
+
 int getReportedCount(){
     return reportedCount;
 }
@@ -51,4 +94,50 @@ int getTelemetryCount() {
 
 int getDesiredCount() {
     return desiredCount;
-}
\ No newline at end of file
+}
+
+int getDroppedCount() {
+    return droppedCount;
+}
+
+int getBytesSavedPerSample() {
+    if (batchedSamples == 0) {
+        return 0;
+    }
+    return (int)(batchBytesSaved / batchedSamples);
+}
+
+unsigned long getMaxLoopTime() {
+    return maxLoopTime;
+}
+
+int getBackpressureCount() {
+    return backpressureCount;
+}
+
+// percentage of channel values left out of telemetry by the deadbands
+int getSuppressionPercent() {
+    long total = channelsSent + channelsSuppressed;
+    if (total == 0) {
+        return 0;
+    }
+    return (int)((channelsSuppressed * 100) / total);
+}
+
+// the counters as one object for the getDeviceStats method, -1 if they do not fit
+int buildCounterStatsJson(char *buffer, int size) {
+    JSON_WRITER writer;
+    jsonWriterInit(&writer, buffer, size);
+    jsonWriterBeginObject(&writer, NULL);
+    jsonWriterAddInt(&writer, "sent", telemetryCount);
+    jsonWriterAddInt(&writer, "failed", errorCount);
+    jsonWriterAddInt(&writer, "desired", desiredCount);
+    jsonWriterAddInt(&writer, "reported", reportedCount);
+    jsonWriterAddInt(&writer, "dropped", droppedCount);
+    jsonWriterAddInt(&writer, "backpressure", backpressureCount);
+    jsonWriterAddInt(&writer, "bytesSavedPerSample", getBytesSavedPerSample());
+    jsonWriterAddInt(&writer, "suppressedPercent", getSuppressionPercent());
+    jsonWriterAddUnsigned(&writer, "maxLoopMs", maxLoopTime);
+    jsonWriterEndObject(&writer);
+    return jsonWriterOverflow(&writer) ? -1 : jsonWriterLength(&writer);
+}
@@ -0,0 +1,209 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+
+#include "../inc/telemetryQueue.h"
+#include "../inc/stats.h"
+#include "../inc/jsonWriter.h"
+#include "../inc/cborWriter.h"
+
+// fixed memory ring of telemetry records waiting to be sent, oldest first
+// records are pushed from the telemetry loop and sent from the outbound worker thread
+static TELEMETRY_RECORD records[TELEMETRY_QUEUE_DEPTH];
+static int head = 0;
+static int count = 0;
+static unsigned long nextSequence = 0;
+static Mutex queueLock;
+
+static void popOldest() {
+    if (count > 0) {
+        head = (head + 1) % TELEMETRY_QUEUE_DEPTH;
+        count--;
+    }
+}
+
+void telemetryQueueClear() {
+    queueLock.lock();
+    head = 0;
+    count = 0;
+    queueLock.unlock();
+}
+
+// when the ring is full the oldest record is overwritten and counted as dropped
+bool telemetryQueuePush(const char *payload, int length, time_t timestamp, TelemetryEncoding encoding) {
+    if (length < 0 || length >= TELEMETRY_PAYLOAD_MAX) {
+        return false;
+    }
+
+    queueLock.lock();
+    if (count == TELEMETRY_QUEUE_DEPTH) {
+        popOldest();
+        incrementDroppedCount();
+    }
+
+    TELEMETRY_RECORD *record = &records[(head + count) % TELEMETRY_QUEUE_DEPTH];
+    memcpy(record->payload, payload, length);
+    record->payload[length] = 0;
+    record->length = length;
+    record->encoding = encoding;
+    record->timestamp = timestamp;
+    record->queued = millis();
+    record->sequence = nextSequence++;
+    count++;
+    queueLock.unlock();
+
+    return true;
+}
+
+// the record is copied out so the ring stays unlocked while it is being sent
+bool telemetryQueueCopyOldest(TELEMETRY_RECORD *record) {
+    bool found = false;
+
+    queueLock.lock();
+    if (count > 0) {
+        memcpy(record, &records[head], sizeof(TELEMETRY_RECORD));
+        found = true;
+    }
+    queueLock.unlock();
+
+    return found;
+}
+
+// removes every record up to and including the sequence number, records that were
+// already dropped to make room while they were being sent are simply gone
+void telemetryQueueRelease(unsigned long sequence) {
+    queueLock.lock();
+    while (count > 0 && (long)(sequence - records[head].sequence) >= 0) {
+        popOldest();
+    }
+    queueLock.unlock();
+}
+
+int telemetryQueueCount() {
+    queueLock.lock();
+    int queued = count;
+    queueLock.unlock();
+
+    return queued;
+}
+
+unsigned long telemetryQueueOldestAge() {
+    unsigned long age = 0;
+
+    queueLock.lock();
+    if (count > 0) {
+        age = millis() - records[head].queued;
+    }
+    queueLock.unlock();
+
+    return age;
+}
+
+static void formatTimestamp(char *timestamp, int size, time_t time) {
+    strftime(timestamp, size, "%Y-%m-%dT%H:%M:%SZ", gmtime(&time));
+}
+
+static void addToBatch(TELEMETRY_BATCH *batch, TELEMETRY_RECORD *record) {
+    if (batch->records == 0) {
+        batch->timestamp = record->timestamp;
+        batch->firstSequence = record->sequence;
+    }
+    batch->records++;
+    batch->recordBytes += record->length;
+    batch->lastSequence = record->sequence;
+}
+
+static int buildJsonBatch(char *buffer, int size, int maxRecords, TELEMETRY_BATCH *batch) {
+    JSON_WRITER writer;
+    jsonWriterInit(&writer, buffer, size);
+    jsonWriterBeginArray(&writer, NULL);
+
+    while (batch->records < maxRecords && batch->records < count) {
+        TELEMETRY_RECORD *record = &records[(head + batch->records) % TELEMETRY_QUEUE_DEPTH];
+        if (record->encoding != TELEMETRY_JSON) {
+            break;
+        }
+        char timestamp[24];
+        formatTimestamp(timestamp, sizeof(timestamp), record->timestamp);
+
+        int mark = jsonWriterLength(&writer);
+        jsonWriterBeginObject(&writer, NULL);
+        jsonWriterAddString(&writer, "timestamp", timestamp);
+        jsonWriterAddMembers(&writer, record->payload, record->length);
+        jsonWriterEndObject(&writer);
+
+        // leave room for the closing bracket, a sample that does not fit waits for the next batch
+        if (jsonWriterOverflow(&writer) || jsonWriterLength(&writer) + 1 >= size) {
+            jsonWriterTruncate(&writer, mark);
+            break;
+        }
+        addToBatch(batch, record);
+    }
+
+    jsonWriterEndArray(&writer);
+    return jsonWriterLength(&writer);
+}
+
+static int buildCborBatch(char *buffer, int size, int maxRecords, TELEMETRY_BATCH *batch) {
+    CBOR_WRITER writer;
+    cborWriterInit(&writer, (uint8_t*)buffer, size);
+    cborWriterBeginArray(&writer, NULL);
+
+    while (batch->records < maxRecords && batch->records < count) {
+        TELEMETRY_RECORD *record = &records[(head + batch->records) % TELEMETRY_QUEUE_DEPTH];
+        if (record->encoding != TELEMETRY_CBOR) {
+            break;
+        }
+        char timestamp[24];
+        formatTimestamp(timestamp, sizeof(timestamp), record->timestamp);
+
+        int mark = cborWriterLength(&writer);
+        cborWriterBeginMap(&writer, NULL);
+        cborWriterAddString(&writer, "timestamp", timestamp);
+        cborWriterAddMembers(&writer, (const uint8_t*)record->payload, record->length);
+        cborWriterEndMap(&writer);
+
+        // leave room for the break that ends the array
+        if (cborWriterOverflow(&writer) || cborWriterLength(&writer) + 1 > size) {
+            cborWriterTruncate(&writer, mark);
+            break;
+        }
+        addToBatch(batch, record);
+    }
+
+    cborWriterEndArray(&writer);
+    return cborWriterLength(&writer);
+}
+
+// packs up to maxRecords of the oldest records into one array in the encoding of the
+// oldest record, each sample carrying its own timestamp, records stay queued until
+// they are released
+int telemetryQueueBuildBatch(char *buffer, int size, int maxRecords, TELEMETRY_BATCH *batch) {
+    int length = -1;
+
+    memset(batch, 0, sizeof(TELEMETRY_BATCH));
+
+    queueLock.lock();
+    if (count > 0) {
+        batch->encoding = records[head].encoding;
+        if (batch->encoding == TELEMETRY_CBOR) {
+            length = buildCborBatch(buffer, size, maxRecords, batch);
+        } else {
+            length = buildJsonBatch(buffer, size, maxRecords, batch);
+        }
+
+        // a record that does not fit an empty batch can never be sent and would block the queue forever
+        if (batch->records == 0) {
+            popOldest();
+            incrementDroppedCount();
+        }
+    }
+    queueLock.unlock();
+
+    if (batch->records == 0) {
+        return -1;
+    }
+    return length;
+}
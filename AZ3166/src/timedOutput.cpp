@@ -0,0 +1,74 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+
+#include "../inc/timedOutput.h"
+
+typedef struct TIMED_OUTPUT_TAG {
+    int pin;
+    unsigned long offTime;
+    bool active;
+} TIMED_OUTPUT;
+
+static TIMED_OUTPUT timedOutputs[TIMED_OUTPUT_MAX];
+
+// pulses are also started from the outbound worker thread
+static Mutex timedOutputLock;
+
+// turns the pin on and returns straight away, updateTimedOutputs turns it off once the duration passed
+void pulseOutput(int pin, unsigned long duration) {
+    timedOutputLock.lock();
+
+    TIMED_OUTPUT *slot = NULL;
+    for (int i = 0; i < TIMED_OUTPUT_MAX; i++) {
+        if (timedOutputs[i].active && timedOutputs[i].pin == pin) {
+            slot = &timedOutputs[i];
+            break;
+        }
+        if (slot == NULL && !timedOutputs[i].active) {
+            slot = &timedOutputs[i];
+        }
+    }
+
+    digitalWrite(pin, 1);
+    if (slot == NULL) {
+        // no free slot, fall back to a blocking pulse rather than leaving the pin on
+        delay(duration);
+        digitalWrite(pin, 0);
+    } else {
+        slot->pin = pin;
+        slot->offTime = millis() + duration;
+        slot->active = true;
+    }
+
+    timedOutputLock.unlock();
+}
+
+void updateTimedOutputs() {
+    timedOutputLock.lock();
+
+    unsigned long now = millis();
+    for (int i = 0; i < TIMED_OUTPUT_MAX; i++) {
+        if (timedOutputs[i].active && (long)(now - timedOutputs[i].offTime) >= 0) {
+            digitalWrite(timedOutputs[i].pin, 0);
+            timedOutputs[i].active = false;
+        }
+    }
+
+    timedOutputLock.unlock();
+}
+
+void clearTimedOutputs() {
+    timedOutputLock.lock();
+
+    for (int i = 0; i < TIMED_OUTPUT_MAX; i++) {
+        if (timedOutputs[i].active) {
+            digitalWrite(timedOutputs[i].pin, 0);
+            timedOutputs[i].active = false;
+        }
+    }
+
+    timedOutputLock.unlock();
+}
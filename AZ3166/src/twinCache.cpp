@@ -0,0 +1,70 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/iotCentral.h"
+#include "../inc/config.h"
+#include "../inc/twinCache.h"
+#include "../inc/utility.h"
+
+#define TWIN_CACHE_MAGIC 0x54574331
+
+static_assert(sizeof(TWIN_CACHE) <= TWIN_CACHE_MAX_LEN, "twin cache does not fit its EEPROM zone");
+
+static TWIN_CACHE cache;
+static bool cacheDirty = false;
+
+static TWIN_CACHE_ENTRY *findEntry(uint32_t nameHash) {
+    for (uint32_t i = 0; i < cache.count; i++) {
+        if (cache.entries[i].nameHash == nameHash) {
+            return &cache.entries[i];
+        }
+    }
+    return NULL;
+}
+
+// reads the cache from EEPROM, a blank or foreign zone starts an empty cache
+void twinCacheLoad() {
+    readTwinCache((uint8_t*)&cache, sizeof(cache));
+    if (cache.magic != TWIN_CACHE_MAGIC || cache.count > TWIN_CACHE_MAX_ENTRIES) {
+        memset(&cache, 0, sizeof(cache));
+        cache.magic = TWIN_CACHE_MAGIC;
+    }
+    cacheDirty = false;
+}
+
+int twinCacheVersion() {
+    return cache.version;
+}
+
+// true when this exact value was applied to the property before
+bool twinCacheMatches(const char *name, const char *value) {
+    TWIN_CACHE_ENTRY *entry = findEntry(hashText(name, false));
+    return entry != NULL && entry->valueHash == hashText(value, false);
+}
+
+void twinCacheUpdate(const char *name, const char *value) {
+    uint32_t nameHash = hashText(name, false);
+    TWIN_CACHE_ENTRY *entry = findEntry(nameHash);
+    if (entry == NULL) {
+        if (cache.count >= TWIN_CACHE_MAX_ENTRIES) {
+            Serial.printf("Twin cache full, %s will be applied again after a reboot\r\n", name);
+            return;
+        }
+        entry = &cache.entries[cache.count++];
+        entry->nameHash = nameHash;
+    }
+    entry->valueHash = hashText(value, false);
+    cacheDirty = true;
+}
+
+// writes the cache back once per processed twin and only when something changed
+void twinCacheCommit(int version) {
+    if (!cacheDirty && cache.version == version) {
+        return;
+    }
+    cache.version = version;
+    storeTwinCache((const uint8_t*)&cache, sizeof(cache));
+    cacheDirty = false;
+}
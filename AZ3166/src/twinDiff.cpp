@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/twinDiff.h"
+#include "../inc/twinIndex.h"
+
+// prints the value of a property as JSON, a value longer than the buffer would be cut
+// off mid token so it is not printed and false is returned
+bool twinValueText(JsonObject& property, char *buffer, size_t size) {
+    if (property["value"].measureLength() >= size) {
+        buffer[0] = 0;
+        return false;
+    }
+    property["value"].printTo(buffer, size);
+    return true;
+}
+
+// indexes the reported properties once, then walks the desired properties and hands
+// every one that changed to onChange, returns the number of changes found
+int twinDiff(JsonObject& desired, JsonObject& reported, twinChangeCallback onChange) {
+    char value[TWIN_DIFF_VALUE_MAX];
+    TWIN_INDEX index;
+
+    if (!twinIndexInit(&index, reported.size())) {
+        Serial.println("Reported properties could not be indexed, every desired property is applied");
+    }
+    for (JsonObject::iterator it = reported.begin(); it != reported.end(); ++it) {
+        // a reported value too long to compare matches nothing
+        if (it->key[0] != '$' && twinValueText(it->value.as<JsonObject>(), value, sizeof(value))) {
+            twinIndexAdd(&index, it->key, value);
+        }
+    }
+    twinIndexSort(&index);
+
+    int version = desired["$version"].as<signed int>();
+    int changeCount = 0;
+
+    for (JsonObject::iterator it = desired.begin(); it != desired.end(); ++it) {
+        if (it->key[0] == '$') {
+            continue;
+        }
+
+        // a desired value too long to compare counts as changed, the handler rejects it
+        JsonObject& property = it->value.as<JsonObject>();
+        if (twinValueText(property, value, sizeof(value)) && twinIndexMatches(&index, it->key, value)) {
+            Serial.printf("key: %s found in reported and values match\r\n", it->key);
+            continue;
+        }
+
+        Serial.printf("key: %s either not found in reported or values do not match\r\n", it->key);
+        onChange(it->key, property, version);
+        changeCount++;
+    }
+
+    twinIndexFree(&index);
+    return changeCount;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/twinIndex.h"
+#include "../inc/utility.h"
+
+static int compareEntries(const void *a, const void *b) {
+    const TWIN_INDEX_ENTRY *left = (const TWIN_INDEX_ENTRY*)a;
+    const TWIN_INDEX_ENTRY *right = (const TWIN_INDEX_ENTRY*)b;
+    if (left->nameHash != right->nameHash) {
+        return left->nameHash < right->nameHash ? -1 : 1;
+    }
+    return strcmp(left->name, right->name);
+}
+
+// an index without entries matches nothing, so every desired property counts as changed
+bool twinIndexInit(TWIN_INDEX *index, int size) {
+    index->entries = NULL;
+    index->size = 0;
+    index->count = 0;
+    if (size <= 0) {
+        return true;
+    }
+
+    index->entries = (TWIN_INDEX_ENTRY *)calloc(size, sizeof(TWIN_INDEX_ENTRY));
+    if (index->entries == NULL) {
+        return false;
+    }
+    index->size = size;
+    return true;
+}
+
+// value is the property value printed as JSON, only its hash is kept
+bool twinIndexAdd(TWIN_INDEX *index, const char *name, const char *value) {
+    if (index->count >= index->size) {
+        return false;
+    }
+
+    TWIN_INDEX_ENTRY *entry = &index->entries[index->count++];
+    entry->nameHash = hashText(name, false);
+    entry->valueHash = hashText(value, false);
+    entry->name = name;
+    return true;
+}
+
+void twinIndexSort(TWIN_INDEX *index) {
+    if (index->count > 1) {
+        qsort(index->entries, index->count, sizeof(TWIN_INDEX_ENTRY), compareEntries);
+    }
+}
+
+// true when the property is reported with this value, the index has to be sorted
+bool twinIndexMatches(const TWIN_INDEX *index, const char *name, const char *value) {
+    uint32_t nameHash = hashText(name, false);
+    int low = 0;
+    int high = index->count;
+
+    // first entry with this name hash, names sharing a hash follow it
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (index->entries[middle].nameHash < nameHash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    for (int i = low; i < index->count && index->entries[i].nameHash == nameHash; i++) {
+        if (strcmp(index->entries[i].name, name) == 0) {
+            return index->entries[i].valueHash == hashText(value, false);
+        }
+    }
+    return false;
+}
+
+void twinIndexFree(TWIN_INDEX *index) {
+    free(index->entries);
+    index->entries = NULL;
+    index->size = 0;
+    index->count = 0;
+}
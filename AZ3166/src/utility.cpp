@@ -6,7 +6,7 @@
 #include "NTPClient.h"
 
 // As there is a problem of sprintf %f in Arduino, follow https://github.com/blynkkk/blynk-library/issues/14 to implement dtostrf
-char * dtostrf(double number, signed char width, unsigned char prec, char *s) {
+char * dtostrf(double number, signed char /* width */, unsigned char prec, char *s) {
     if(isnan(number)) {
         strcpy(s, "nan");
         return s;
@@ -37,7 +37,7 @@ char * dtostrf(double number, signed char width, unsigned char prec, char *s) {
     // Extract the integer part of the number and print it
     unsigned long int_part = (unsigned long) number;
     double remainder = number - (double) int_part;
-    out += sprintf(out, "%d", int_part);
+    out += sprintf(out, "%lu", int_part);
 
     // Print the decimal point, but only if there are digits beyond
     if(prec > 0) {
@@ -89,7 +89,7 @@ String urldecode(String str) {
     char c;
     char code0;
     char code1;
-    for (int i =0; i < str.length(); i++) {
+    for (unsigned int i =0; i < str.length(); i++) {
         c=str.charAt(i);
         if (c == '+') {
             encodedString+=' ';  
@@ -118,7 +118,7 @@ bool SyncTimeToNTP() {
         "oceania.pool.ntp.org"
     };
 
-    for (int i = 0; i < sizeof(ntpHost) / sizeof(ntpHost[0]); i++) {
+    for (unsigned int i = 0; i < sizeof(ntpHost) / sizeof(ntpHost[0]); i++) {
             NTPClient ntp(WiFiInterface());
             NTPResult res = ntp.setTime((char*)ntpHost[i]);
             if (res == NTP_OK) {
@@ -141,3 +141,15 @@ int _stricmp(const char *a, const char *b) {
     } while (ca == cb && ca != '\0');
     return ca - cb;
 }
+
+// 32 bit FNV-1a, ignoring case gives names that _stricmp finds equal the same hash,
+// the twin cache keeps these hashes in EEPROM so the function cannot change
+uint32_t hashText(const char *text, bool ignoreCase) {
+    uint32_t hash = 2166136261u;
+    while (*text != 0) {
+        unsigned char c = (unsigned char)*text++;
+        hash ^= ignoreCase ? (uint8_t)tolower(c) : c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
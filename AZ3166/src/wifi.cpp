@@ -5,6 +5,7 @@
 #include "AZ3166WiFi.h"
 
 #include "../inc/config.h"
+#include "../inc/displayCache.h"
 
 bool initApWiFi() {
     char ap_name[14];
@@ -15,6 +16,7 @@ bool initApWiFi() {
     sprintf(macAddress, "mac:%02X%02X%02X%02X%02X%02X", mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
     int ret = WiFi.beginAP(ap_name, "");
 
+    displayLock();
     Screen.print(0, "WiFi name:");
     Screen.print(1, ap_name);
     Screen.print(2, macAddress);
@@ -24,9 +26,11 @@ bool initApWiFi() {
       Screen.print(0, "AP Failed:");
       Screen.print(2, "Reboot device");
       Screen.print(3, "and try again");
+      displayUnlock();
       Serial.println("AP creation failed");
       return false;
     }
+    displayUnlock();
     Serial.println("AP started");
     return true;
 }
@@ -35,7 +39,9 @@ bool initWiFi() {
     bool connected = false;
     char wifiBuff[128];
 
+    displayLock();
     Screen.print("WiFi \r\n \r\nConnecting...\r\n             \r\n");
+    displayUnlock();
     
     if(WiFi.begin() == WL_CONNECTED) {
         digitalWrite(LED_WIFI, 1);
@@ -90,5 +96,5 @@ void displayNetworkInfo() {
     byte mac[6];
     WiFi.macAddress(mac);
     sprintf(buff, "WiFi:\r\n%s\r\n%s\r\mac:%02X%02X%02X%02X%02X%02X", WiFi.SSID(), ip.get_address(), mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
-    Screen.print(0, buff);
+    displayPrint(0, buff);
 }
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/callbackTable.h"
+#include "../inc/utility.h"
+
+#include "testing.h"
+
+static int handler0(JsonObject& /* payload */, char * /* response */, size_t /* responseSize */) { return 0; }
+static int handler1(JsonObject& /* payload */, char * /* response */, size_t /* responseSize */) { return 1; }
+static int handler2(JsonObject& /* payload */, char * /* response */, size_t /* responseSize */) { return 2; }
+static int handler3(JsonObject& /* payload */, char * /* response */, size_t /* responseSize */) { return 3; }
+
+static const methodCallback handlers[] = { handler0, handler1, handler2, handler3 };
+
+#define MAX_NAMES 256
+
+static char names[MAX_NAMES][32];
+
+// the registration list the table replaced, first match wins
+typedef struct LINEAR_ENTRY_TAG {
+    const char *name;
+    methodCallback callback;
+} LINEAR_ENTRY;
+
+static LINEAR_ENTRY linear[MAX_NAMES];
+static int linearCount = 0;
+
+static methodCallback linearFind(const char *name) {
+    for (int i = 0; i < linearCount; i++) {
+        if (_stricmp(linear[i].name, name) == 0) {
+            return linear[i].callback;
+        }
+    }
+    return NULL;
+}
+
+static void fillTable(CALLBACK_TABLE *table, int count) {
+    memset(table, 0, sizeof(CALLBACK_TABLE));
+    linearCount = 0;
+    for (int i = 0; i < count; i++) {
+        snprintf(names[i], sizeof(names[i]), "%sProperty%d", (i % 2) ? "set" : "get", i);
+        CHECK(callbackTableAdd(table, names[i], handlers[i % 4]));
+        linear[linearCount].name = names[i];
+        linear[linearCount].callback = handlers[i % 4];
+        linearCount++;
+    }
+}
+
+static void freeTable(CALLBACK_TABLE *table) {
+    for (int i = 0; i < table->size; i++) {
+        free(table->entries[i].name);
+    }
+    free(table->entries);
+}
+
+static void testRegistrationAndLookup() {
+    CALLBACK_TABLE table;
+    memset(&table, 0, sizeof(table));
+
+    CHECK(callbackTableFind(&table, "fanSpeed") == NULL);
+    CHECK(callbackTableAdd(&table, "fanSpeed", handler1));
+    CHECK(callbackTableFind(&table, "FANSPEED") == handler1);
+    CHECK(callbackTableFind(&table, "fanSpeedX") == NULL);
+    CHECK(callbackTableFind(&table, NULL) == NULL);
+
+    // the first registration of a name wins, case does not matter
+    CHECK(!callbackTableAdd(&table, "FanSpeed", handler2));
+    CHECK(callbackTableFind(&table, "fanspeed") == handler1);
+    CHECK(!callbackTableAdd(&table, NULL, handler2));
+    CHECK(!callbackTableAdd(&table, "other", NULL));
+    CHECK_EQUAL_INT(1, table.count);
+    freeTable(&table);
+}
+
+// every table size up to 256 handlers gives the same answers as the linear scan
+static void testGrowsAndMatchesLinearScan() {
+    CALLBACK_TABLE table;
+    fillTable(&table, MAX_NAMES);
+
+    CHECK_EQUAL_INT(MAX_NAMES, table.count);
+    CHECK(table.size >= MAX_NAMES * 2);
+    CHECK(table.collisions <= table.count);
+
+    int collided = 0;
+    for (int i = 0; i < table.size; i++) {
+        CALLBACK_ENTRY *entry = &table.entries[i];
+        if (entry->callback != NULL && (int)(entry->hash & (table.size - 1)) != i) {
+            collided++;
+        }
+    }
+    CHECK_EQUAL_INT(collided, table.collisions);
+
+    for (int i = 0; i < MAX_NAMES; i++) {
+        CHECK(callbackTableFind(&table, names[i]) == linearFind(names[i]));
+        CHECK(callbackTableFind(&table, names[i]) == handlers[i % 4]);
+    }
+    CHECK(callbackTableFind(&table, "getProperty256") == NULL);
+    printf("256 handlers: %d slots, %d entries off their home slot\n", table.size, table.collisions);
+    freeTable(&table);
+}
+
+static void benchmark(int handlerCount) {
+    const int lookups = 200000;
+    CALLBACK_TABLE table;
+    fillTable(&table, handlerCount);
+
+    unsigned long found = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        found += linearFind(names[i % handlerCount]) != NULL;
+    }
+    double linearMicros = elapsedMicros(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        found += callbackTableFind(&table, names[i % handlerCount]) != NULL;
+    }
+    double tableMicros = elapsedMicros(start);
+
+    CHECK_EQUAL_INT(2 * lookups, found);
+    printf("%3d handlers: linear %.1f ns/lookup, table %.1f ns/lookup\n",
+        handlerCount, linearMicros * 1000 / lookups, tableMicros * 1000 / lookups);
+    freeTable(&table);
+}
+
+int main() {
+    testRegistrationAndLookup();
+    testGrowsAndMatchesLinearScan();
+    benchmark(4);
+    benchmark(32);
+    benchmark(256);
+    return testResult("callbackTableTest");
+}
@@ -0,0 +1,307 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include <limits.h>
+
+#include "../inc/cborWriter.h"
+#include "../inc/jsonWriter.h"
+
+#include "testing.h"
+
+// a small RFC 7049 decoder independent of the writer, it renders items as JSON text
+// and returns false on anything malformed or truncated
+typedef struct CBOR_READER_TAG {
+    const uint8_t *data;
+    int length;
+    int position;
+} CBOR_READER;
+
+static bool readByte(CBOR_READER *reader, uint8_t *value) {
+    if (reader->position >= reader->length) {
+        return false;
+    }
+    *value = reader->data[reader->position++];
+    return true;
+}
+
+static bool readArgument(CBOR_READER *reader, uint8_t info, uint64_t *value) {
+    if (info < 24) {
+        *value = info;
+        return true;
+    }
+    if (info > 27) {
+        return false;
+    }
+
+    int bytes = 1 << (info - 24);
+    *value = 0;
+    for (int i = 0; i < bytes; i++) {
+        uint8_t next;
+        if (!readByte(reader, &next)) {
+            return false;
+        }
+        *value = (*value << 8) | next;
+    }
+    return true;
+}
+
+static bool peekBreak(CBOR_READER *reader) {
+    if (reader->position < reader->length && reader->data[reader->position] == 0xFF) {
+        reader->position++;
+        return true;
+    }
+    return false;
+}
+
+static bool decodeItem(CBOR_READER *reader, std::string &out);
+
+// items of an array or members of a map, definite or indefinite length
+static bool decodeContainer(CBOR_READER *reader, bool map, bool indefinite, uint64_t count, std::string &out) {
+    out += map ? '{' : '[';
+    for (uint64_t i = 0; indefinite || i < count; i++) {
+        if (indefinite && peekBreak(reader)) {
+            break;
+        }
+        if (i > 0) {
+            out += ',';
+        }
+        if (map) {
+            // the firmware only writes text keys
+            if (reader->position >= reader->length || (reader->data[reader->position] & 0xE0) != 0x60) {
+                return false;
+            }
+            if (!decodeItem(reader, out)) {
+                return false;
+            }
+            out += ':';
+        }
+        if (!decodeItem(reader, out)) {
+            return false;
+        }
+    }
+    out += map ? '}' : ']';
+    return true;
+}
+
+static bool decodeItem(CBOR_READER *reader, std::string &out) {
+    uint8_t initial;
+    if (!readByte(reader, &initial)) {
+        return false;
+    }
+    uint8_t major = initial >> 5;
+    uint8_t info = initial & 0x1F;
+    uint64_t argument = 0;
+    char number[32];
+
+    if (major == 4 || major == 5) {
+        if (info == 31) {
+            return decodeContainer(reader, major == 5, true, 0, out);
+        }
+        return readArgument(reader, info, &argument) && decodeContainer(reader, major == 5, false, argument, out);
+    }
+
+    if (major == 7) {
+        if (info != 26) {
+            return false;
+        }
+        uint64_t bits;
+        if (!readArgument(reader, info, &bits)) {
+            return false;
+        }
+        uint32_t bits32 = (uint32_t)bits;
+        float value;
+        memcpy(&value, &bits32, sizeof(value));
+        snprintf(number, sizeof(number), "%.9g", value);
+        out += number;
+        return true;
+    }
+
+    if (!readArgument(reader, info, &argument)) {
+        return false;
+    }
+    switch (major) {
+        case 0:
+            snprintf(number, sizeof(number), "%llu", (unsigned long long)argument);
+            out += number;
+            return true;
+        case 1:
+            snprintf(number, sizeof(number), "%lld", -1 - (long long)argument);
+            out += number;
+            return true;
+        case 3:
+            if (reader->position + (int)argument > reader->length) {
+                return false;
+            }
+            out += '"';
+            out.append((const char*)reader->data + reader->position, argument);
+            out += '"';
+            reader->position += argument;
+            return true;
+    }
+    return false;
+}
+
+// decodes a whole payload, trailing bytes are an error
+static bool decode(const uint8_t *data, int length, std::string &out) {
+    CBOR_READER reader = { data, length, 0 };
+    out.clear();
+    return decodeItem(&reader, out) && reader.position == length;
+}
+
+static void testIntegerHeads() {
+    static const int values[] = { 0, 1, 23, 24, 255, 256, 65535, 65536, INT_MAX,
+        -1, -24, -25, -256, -257, -65536, -65537, INT_MIN };
+    uint8_t buffer[16];
+    CBOR_WRITER writer;
+    std::string decoded;
+
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        cborWriterInit(&writer, buffer, sizeof(buffer));
+        cborWriterAddInt(&writer, NULL, values[i]);
+        CHECK(decode(buffer, cborWriterLength(&writer), decoded));
+        CHECK_EQUAL_TEXT(std::to_string(values[i]).c_str(), decoded.c_str());
+
+        // shortest form of the argument
+        uint32_t magnitude = values[i] >= 0 ? values[i] : (uint32_t)(-1 - values[i]);
+        int expected = magnitude < 24 ? 1 : magnitude <= 0xFF ? 2 : magnitude <= 0xFFFF ? 3 : 5;
+        CHECK_EQUAL_INT(expected, cborWriterLength(&writer));
+    }
+}
+
+static void testFloatsExact() {
+    static const float values[] = { 0.0f, 21.5f, -0.1f, 1013.25f, 3.4e38f, -1.5e-38f };
+    uint8_t buffer[8];
+    CBOR_WRITER writer;
+    std::string decoded;
+
+    for (unsigned int i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        cborWriterInit(&writer, buffer, sizeof(buffer));
+        cborWriterAddFloat(&writer, NULL, values[i]);
+        CHECK_EQUAL_INT(5, cborWriterLength(&writer));
+        CHECK(decode(buffer, 5, decoded));
+        CHECK(strtof(decoded.c_str(), NULL) == values[i]);
+    }
+}
+
+static void testStringLengths() {
+    static uint8_t buffer[400];
+    static char text[301];
+    CBOR_WRITER writer;
+    std::string decoded;
+
+    for (int length = 0; length <= 300; length++) {
+        memset(text, 'a' + length % 26, length);
+        text[length] = 0;
+        cborWriterInit(&writer, buffer, sizeof(buffer));
+        cborWriterAddString(&writer, NULL, text);
+        CHECK(decode(buffer, cborWriterLength(&writer), decoded));
+        CHECK_EQUAL_TEXT(("\"" + std::string(text) + "\"").c_str(), decoded.c_str());
+    }
+}
+
+// the same documents written as JSON and as CBOR decode to the same text
+static void testRoundTripAgainstJson() {
+    uint8_t cbor[512];
+    char json[512];
+    std::string decoded;
+
+    srand(19);
+    for (int round = 0; round < 500; round++) {
+        CBOR_WRITER cborWriter;
+        JSON_WRITER jsonWriter;
+        cborWriterInit(&cborWriter, cbor, sizeof(cbor));
+        jsonWriterInit(&jsonWriter, json, sizeof(json));
+        cborWriterBeginMap(&cborWriter, NULL);
+        jsonWriterBeginObject(&jsonWriter, NULL);
+
+        int members = rand() % 8;
+        for (int i = 0; i < members; i++) {
+            char key[16];
+            snprintf(key, sizeof(key), "key%d", i);
+            int value = rand() - RAND_MAX / 2;
+            switch (rand() % 4) {
+                case 0:
+                    cborWriterAddInt(&cborWriter, key, value);
+                    jsonWriterAddInt(&jsonWriter, key, value);
+                    break;
+                case 1:
+                    cborWriterAddString(&cborWriter, key, "text value");
+                    jsonWriterAddString(&jsonWriter, key, "text value");
+                    break;
+                case 2:
+                    cborWriterBeginArray(&cborWriter, key);
+                    jsonWriterBeginArray(&jsonWriter, key);
+                    for (int j = 0; j < value % 5 + 4; j++) {
+                        cborWriterAddInt(&cborWriter, NULL, j * value);
+                        jsonWriterAddInt(&jsonWriter, NULL, j * value);
+                    }
+                    cborWriterEndArray(&cborWriter);
+                    jsonWriterEndArray(&jsonWriter);
+                    break;
+                case 3:
+                    cborWriterBeginMap(&cborWriter, key);
+                    jsonWriterBeginObject(&jsonWriter, key);
+                    cborWriterAddInt(&cborWriter, "inner", value);
+                    jsonWriterAddInt(&jsonWriter, "inner", value);
+                    cborWriterEndMap(&cborWriter);
+                    jsonWriterEndObject(&jsonWriter);
+                    break;
+            }
+        }
+
+        cborWriterEndMap(&cborWriter);
+        jsonWriterEndObject(&jsonWriter);
+        CHECK(!cborWriterOverflow(&cborWriter));
+        CHECK(decode(cbor, cborWriterLength(&cborWriter), decoded));
+        CHECK_EQUAL_TEXT(json, decoded.c_str());
+    }
+}
+
+// a record merged into a batch keeps its members, a record that is not a map is refused
+static void testAddMembersAndTruncate() {
+    uint8_t record[64];
+    uint8_t batch[64];
+    CBOR_WRITER writer;
+    std::string decoded;
+
+    cborWriterInit(&writer, record, sizeof(record));
+    cborWriterBeginMap(&writer, NULL);
+    cborWriterAddInt(&writer, "temp", 21);
+    cborWriterAddString(&writer, "unit", "C");
+    cborWriterEndMap(&writer);
+    int recordLength = cborWriterLength(&writer);
+
+    cborWriterInit(&writer, batch, sizeof(batch));
+    cborWriterBeginMap(&writer, NULL);
+    cborWriterAddInt(&writer, "sampleCount", 3);
+    cborWriterAddMembers(&writer, record, recordLength);
+    int mark = cborWriterLength(&writer);
+    cborWriterAddMembers(&writer, record + 1, recordLength - 1);
+    CHECK(cborWriterOverflow(&writer));
+    cborWriterTruncate(&writer, mark);
+    cborWriterEndMap(&writer);
+
+    CHECK(!cborWriterOverflow(&writer));
+    CHECK(decode(batch, cborWriterLength(&writer), decoded));
+    CHECK_EQUAL_TEXT("{\"sampleCount\":3,\"temp\":21,\"unit\":\"C\"}", decoded.c_str());
+
+    // output cut short by a full buffer is reported and does not decode
+    uint8_t small[6];
+    cborWriterInit(&writer, small, sizeof(small));
+    cborWriterBeginMap(&writer, NULL);
+    cborWriterAddString(&writer, "name", "value");
+    cborWriterEndMap(&writer);
+    CHECK(cborWriterOverflow(&writer));
+    CHECK(!decode(small, cborWriterLength(&writer), decoded));
+}
+
+int main() {
+    testIntegerHeads();
+    testFloatsExact();
+    testStringLengths();
+    testRoundTripAgainstJson();
+    testAddMembersAndTruncate();
+    return testResult("cborWriterTest");
+}
@@ -0,0 +1,59 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/sensors.h"
+#include "../inc/sensorSampler.h"
+#include "../inc/deadband.h"
+
+#include "testing.h"
+
+// the sampler is linked for its channel table only, its readers are never called
+float readHumidity() { return 0; }
+float readTemperature() { return 0; }
+unsigned long getHumidityTemperatureTime() { return 0; }
+float readPressure() { return 0; }
+void readMagnetometer(int * /* axes */) {}
+void readAccelerometer(int * /* axes */) {}
+void readGyroscope(int * /* axes */) {}
+bool isMotionFifoEnabled() { return false; }
+int drainMotionFifo() { return 0; }
+bool takeMotionSample(MOTION_SAMPLE * /* sample */) { return false; }
+
+// temperature has a deadband of 0.5 degrees, the others send every value
+static const uint8_t thresholds[DEADBAND_SENSOR_COUNT] = { 5, 0, 0, 0, 0, 0 };
+
+static void testThresholdAndHeartbeat() {
+    deadbandConfigure(thresholds, 60000);
+
+    CHECK(deadbandCheck(CHANNEL_TEMP, 21.0f, 0));
+    CHECK(!deadbandCheck(CHANNEL_TEMP, 21.4f, 1000));
+    CHECK(deadbandCheck(CHANNEL_TEMP, 21.6f, 2000));
+    CHECK(!deadbandCheck(CHANNEL_TEMP, 21.6f, 61999));
+    CHECK(deadbandCheck(CHANNEL_TEMP, 21.6f, 62000));
+    CHECK(deadbandCheck(CHANNEL_HUMIDITY, 40.0f, 62000));
+    CHECK(deadbandCheck(CHANNEL_HUMIDITY, 40.0f, 62001));
+}
+
+// a heartbeat of 0 is not "never", a steady channel still goes out at the default
+static void testZeroHeartbeatUsesDefault() {
+    deadbandConfigure(thresholds, 0);
+
+    CHECK(deadbandCheck(CHANNEL_TEMP, 21.0f, 0));
+    int sends = 0;
+    for (unsigned long now = 5000; now <= 2 * DEADBAND_HEARTBEAT_DEFAULT; now += 5000) {
+        sends += deadbandCheck(CHANNEL_TEMP, 21.0f, now);
+    }
+    CHECK_EQUAL_INT(2, sends);
+
+    // clearing, e.g. after a reconnect, sends every channel once more
+    deadbandClear();
+    CHECK(deadbandCheck(CHANNEL_TEMP, 21.0f, 2 * DEADBAND_HEARTBEAT_DEFAULT + 1));
+}
+
+int main() {
+    testThresholdAndHeartbeat();
+    testZeroHeartbeatUsesDefault();
+    return testResult("deadbandTest");
+}
@@ -0,0 +1,97 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/displayCache.h"
+
+#include "testing.h"
+
+static void testOnlyChangedLinesArePrinted() {
+    Screen.reset();
+    clearDisplayStats();
+    displayInvalidate();
+
+    displayPrint(0, "page\r\nsent: 1\r\nfail: 0\r\ntwin: 0/0");
+    CHECK_EQUAL_INT(1, Screen.cleans);
+    CHECK_EQUAL_INT(4, Screen.prints);
+    CHECK_EQUAL_TEXT("sent: 1", Screen.lastText[1]);
+
+    displayPrint(0, "page\r\nsent: 2\r\nfail: 0\r\ntwin: 0/0");
+    CHECK_EQUAL_INT(5, Screen.prints);
+    CHECK_EQUAL_TEXT("sent: 2", Screen.lastText[1]);
+
+    // lines are cut to the panel width, so a change past it is nothing to send
+    displayPrint(3, "twin: 0/0       and more");
+    CHECK_EQUAL_INT(5, Screen.prints);
+
+    // a shorter line only blanks what the longer one left behind
+    displayPrint(1, "sent: 10000");
+    displayPrint(1, "x");
+    CHECK_EQUAL_TEXT("x          ", Screen.lastText[1]);
+
+    displayInvalidate();
+    displayPrint(0, "page\r\nsent: 2\r\nfail: 0\r\ntwin: 0/0");
+    CHECK_EQUAL_INT(2, Screen.cleans);
+    CHECK_EQUAL_INT(11, Screen.prints);
+}
+
+// the counters follow what went to the panel, not a fixed cost per line
+static void testBytesMeasured() {
+    Screen.reset();
+    hostSetMillis(100000);
+    clearDisplayStats();
+    displayInvalidate();
+
+    displayPrint(0, "page\r\nsent: 1\r\nfail: 0\r\ntwin: 0/0");
+    CHECK_EQUAL_INT(Screen.bytes, getDisplayBytesWritten());
+    CHECK_EQUAL_INT(DISPLAY_CLEAN_BYTES + (4 + 7 + 7 + 9) * DISPLAY_CHAR_BYTES, getDisplayBytesWritten());
+
+    // one character changed, the line is sent up to its end and the other three are skipped
+    for (int i = 0; i < 10; i++) {
+        char page[64];
+        snprintf(page, sizeof(page), "page\r\nsent: %d\r\nfail: 0\r\ntwin: 0/0", i);
+        displayPrint(0, page);
+        hostAdvanceMillis(100);
+    }
+    displayMessage("New message:", "hello", 0);
+    CHECK_EQUAL_INT(Screen.bytes, getDisplayBytesWritten());
+
+    // 11 refreshes of four lines against 16 characters each, less the 4 + 7 + 7 + 9 and 10 x 7
+    // characters sent, over one second
+    unsigned long saved = (11 * 4 * DISPLAY_LINE_CHARS - (4 + 7 + 7 + 9) - 10 * 7) * DISPLAY_CHAR_BYTES;
+    CHECK_EQUAL_INT(saved, getDisplayBytesSavedPerSecond());
+}
+
+// a message keeps the screen for its hold time, then the next print redraws the page
+static void testMessageHold() {
+    Screen.reset();
+    hostSetMillis(10000);
+
+    displayMessage("New message:", "hello", 2000);
+    CHECK_EQUAL_INT(1, Screen.cleans);
+    CHECK_EQUAL_TEXT("New message:", Screen.lastText[0]);
+    CHECK_EQUAL_TEXT("hello", Screen.lastText[1]);
+    CHECK(displayHeld());
+
+    hostAdvanceMillis(1999);
+    CHECK(displayHeld());
+    hostAdvanceMillis(1);
+    CHECK(!displayHeld());
+
+    displayPrint(0, "page");
+    CHECK_EQUAL_INT(2, Screen.cleans);
+    CHECK_EQUAL_TEXT("page", Screen.lastText[0]);
+
+    // a title without text leaves the rest of the screen blank
+    displayMessage("Firing IR beam", NULL, 0);
+    CHECK_EQUAL_TEXT("", Screen.lastText[1]);
+    CHECK(!displayHeld());
+}
+
+int main() {
+    testOnlyChangedLinesArePrinted();
+    testBytesMeasured();
+    testMessageHold();
+    return testResult("displayCacheTest");
+}
@@ -0,0 +1,89 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/inboundMessage.h"
+
+#include "hostHeap.h"
+#include "testing.h"
+
+// payloads as IoT Central sends them, C2D messages carry the method name, direct methods only the payload
+static const char *recordedPayloads[] = {
+    "{\"methodName\":\"message\",\"payload\":{\"text\":\"Hello from IoT Central\"}}",
+    "{\"methodName\":\"message\",\"payload\":\"{\\\"text\\\":\\\"sent as a string\\\"}\"}",
+    "{\"cycles\":5}",
+    "{}",
+    "{\"methodName\":\"message\",\"payload\":{\"text\":\"\\u00e4\\u00f6\\u00fc line\\r\\nbreak\"}}",
+};
+
+static void testCopiesAndTerminates() {
+    for (unsigned int i = 0; i < sizeof(recordedPayloads) / sizeof(recordedPayloads[0]); i++) {
+        int length = strlen(recordedPayloads[i]);
+        CHECK(inboundMessageCopy(recordedPayloads[i], length));
+        CHECK_EQUAL_INT(length, inboundMessageLength());
+        CHECK_EQUAL_TEXT(recordedPayloads[i], inboundMessageText());
+    }
+
+    // the SDK passes the payload without a terminator, nothing past length is read
+    const char unterminated[] = { '{', '}', 'x', 'y' };
+    CHECK(inboundMessageCopy(unterminated, 2));
+    CHECK_EQUAL_TEXT("{}", inboundMessageText());
+
+    // a method called without a payload is an empty message
+    CHECK(inboundMessageCopy(NULL, 10));
+    CHECK_EQUAL_INT(0, inboundMessageLength());
+    CHECK_EQUAL_TEXT("", inboundMessageText());
+}
+
+static void testOversizeDropped() {
+    static char large[INBOUND_MESSAGE_MAX + 1];
+    memset(large, 'a', sizeof(large));
+
+    CHECK(inboundMessageCopy(large, INBOUND_MESSAGE_MAX - 1));
+    CHECK_EQUAL_INT(INBOUND_MESSAGE_MAX - 1, (int)strlen(inboundMessageText()));
+
+    CHECK(inboundMessageCopy("{}", 2));
+    CHECK(!inboundMessageCopy(large, INBOUND_MESSAGE_MAX));
+    CHECK_EQUAL_TEXT("{}", inboundMessageText());
+}
+
+// the old path calloc'd a copy of every message, the fixed buffer takes nothing from the heap
+static void benchmarkRecordedPayloads() {
+    const int rounds = 100000;
+    const int count = sizeof(recordedPayloads) / sizeof(recordedPayloads[0]);
+
+    unsigned long allocations = hostHeapAllocations();
+    hostHeapResetPeak();
+    long long heapBefore = hostHeapInUse();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        const char *payload = recordedPayloads[i % count];
+        inboundMessageCopy(payload, strlen(payload));
+    }
+    double copyMicros = elapsedMicros(start);
+    CHECK_EQUAL_INT(0, hostHeapAllocations() - allocations);
+    CHECK_EQUAL_INT(heapBefore, hostHeapPeak());
+
+    // called through a volatile pointer so the compiler cannot drop the allocation
+    void (*volatile release)(void *) = free;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        const char *payload = recordedPayloads[i % count];
+        int length = strlen(payload);
+        char *buffer = (char *)calloc(length + 1, 1);
+        memcpy(buffer, payload, length);
+        release(buffer);
+    }
+    double callocMicros = elapsedMicros(start);
+
+    printf("inbound copy: fixed buffer %.1f ns and 0 heap bytes per message, calloc copy %.1f ns and up to %lld heap bytes\n",
+        copyMicros * 1000 / rounds, callocMicros * 1000 / rounds, hostHeapPeak() - heapBefore);
+}
+
+int main() {
+    testCopiesAndTerminates();
+    testOversizeDropped();
+    benchmarkRecordedPayloads();
+    return testResult("inboundMessageTest");
+}
@@ -0,0 +1,123 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+// built against ArduinoJson 5 itself rather than the stub, see ARDUINOJSON_DIR in CMakeLists.txt
+#include <ArduinoJson.h>
+
+#include "Arduino.h"
+
+#include "../inc/inboundMessage.h"
+
+#include "hostHeap.h"
+#include "testing.h"
+
+// payloads as IoT Central sends them, C2D messages carry the method name, direct methods only the payload
+static const char *recordedPayloads[] = {
+    "{\"methodName\":\"message\",\"payload\":{\"text\":\"Hello from IoT Central\"}}",
+    "{\"methodName\":\"message\",\"payload\":\"{\\\"text\\\":\\\"sent as a string\\\"}\"}",
+    "{\"cycles\":5}",
+    "{}",
+    "{\"methodName\":\"message\",\"payload\":{\"text\":\"\\u00e4\\u00f6\\u00fc line\\r\\nbreak\"}}",
+};
+
+static const int recordedCount = sizeof(recordedPayloads) / sizeof(recordedPayloads[0]);
+
+// an object of count members named a0, a1, ... with the value 0, the smallest members that
+// still differ, returns the length written
+static int manyMembers(char *buffer, int size, int count) {
+    int length = snprintf(buffer, size, "{");
+    for (int i = 0; i < count && length < size; i++) {
+        length += snprintf(buffer + length, size - length, "%s\"a%d\":0", (i == 0) ? "" : ",", i);
+    }
+    if (length < size) {
+        length += snprintf(buffer + length, size - length, "}");
+    }
+    return length;
+}
+
+static void testRecordedPayloadsFitArena() {
+    for (int i = 0; i < recordedCount; i++) {
+        CHECK(inboundMessageCopy(recordedPayloads[i], strlen(recordedPayloads[i])));
+        StaticJsonBuffer<INBOUND_JSON_ARENA> jsonBuffer;
+        JsonObject& root = jsonBuffer.parseObject(inboundMessageText());
+        CHECK(root.success());
+    }
+}
+
+// a message that fits the inbound buffer can still need more arena than there is, the
+// parse fails instead of handing the handler a partial object
+static void testManyMembersFailToParse() {
+    static char payload[INBOUND_MESSAGE_MAX];
+    int members = 0;
+    int length = 0;
+    for (int count = 1; ; count++) {
+        int next = manyMembers(payload, sizeof(payload), count);
+        if (next >= INBOUND_MESSAGE_MAX) {
+            break;
+        }
+        members = count;
+        length = next;
+    }
+    manyMembers(payload, sizeof(payload), members);
+
+    CHECK(inboundMessageCopy(payload, length));
+    StaticJsonBuffer<INBOUND_JSON_ARENA> jsonBuffer;
+    JsonObject& root = jsonBuffer.parseObject(inboundMessageText());
+    CHECK(!root.success());
+
+    // the same message parses once the arena holds a node per member
+    CHECK(inboundMessageCopy(payload, length));
+    DynamicJsonBuffer largeBuffer;
+    JsonObject& large = largeBuffer.parseObject(inboundMessageText());
+    CHECK(large.success());
+    CHECK_EQUAL_INT(members, (int)large.size());
+
+    printf("inbound parse: %d members in %d bytes need %d arena bytes, the arena has %d\n",
+        members, length, (int)largeBuffer.size(), INBOUND_JSON_ARENA);
+}
+
+// the handlers parse with a StaticJsonBuffer on the stack, the alternative is a DynamicJsonBuffer
+// that grows on the heap, both parse the copy in the inbound buffer in place
+static void benchmarkParse() {
+    const int rounds = 100000;
+    int parsed = 0;
+
+    unsigned long allocations = hostHeapAllocations();
+    hostHeapResetPeak();
+    long long heapBefore = hostHeapInUse();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        const char *payload = recordedPayloads[i % recordedCount];
+        inboundMessageCopy(payload, strlen(payload));
+        StaticJsonBuffer<INBOUND_JSON_ARENA> jsonBuffer;
+        parsed += jsonBuffer.parseObject(inboundMessageText()).success() ? 1 : 0;
+    }
+    double staticMicros = elapsedMicros(start);
+    CHECK_EQUAL_INT(rounds, parsed);
+    CHECK_EQUAL_INT(0, hostHeapAllocations() - allocations);
+    CHECK_EQUAL_INT(heapBefore, hostHeapPeak());
+
+    parsed = 0;
+    allocations = hostHeapAllocations();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        const char *payload = recordedPayloads[i % recordedCount];
+        inboundMessageCopy(payload, strlen(payload));
+        DynamicJsonBuffer jsonBuffer;
+        parsed += jsonBuffer.parseObject(inboundMessageText()).success() ? 1 : 0;
+    }
+    double dynamicMicros = elapsedMicros(start);
+    CHECK_EQUAL_INT(rounds, parsed);
+    unsigned long dynamicAllocations = hostHeapAllocations() - allocations;
+    CHECK(dynamicAllocations >= (unsigned long)rounds);
+
+    printf("inbound parse: StaticJsonBuffer %.1f ns and 0 heap allocations per message, DynamicJsonBuffer %.1f ns and %.1f allocations of up to %lld heap bytes\n",
+        staticMicros * 1000 / rounds, dynamicMicros * 1000 / rounds, (double)dynamicAllocations / rounds, hostHeapPeak() - heapBefore);
+}
+
+int main() {
+    testRecordedPayloadsFitArena();
+    testManyMembersFailToParse();
+    benchmarkParse();
+    return testResult("inboundParseTest");
+}
@@ -0,0 +1,249 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/iotCentral.h"
+#include "../inc/jsonWriter.h"
+#include "../inc/config.h"
+
+#include "testing.h"
+
+typedef struct READINGS_TAG {
+    float humidity;
+    float temp;
+    float pressure;
+    int mag[3];
+    int accel[3];
+    int gyro[3];
+} READINGS;
+
+// the String based payload builder the writer replaced, kept as the reference output
+static String stringPayload(uint8_t telemetryState, const READINGS *r) {
+    String payload = "{";
+
+    if ((telemetryState & HUMIDITY_CHECKED) == HUMIDITY_CHECKED) {
+        payload.concat(",\"humidity\":");
+        payload.concat(String(r->humidity));
+    }
+    if ((telemetryState & TEMP_CHECKED) == TEMP_CHECKED) {
+        payload.concat(",\"temp\":");
+        payload.concat(String(r->temp));
+    }
+    if ((telemetryState & PRESSURE_CHECKED) == PRESSURE_CHECKED) {
+        payload.concat(",\"pressure\":");
+        payload.concat(String(r->pressure));
+    }
+    if ((telemetryState & MAG_CHECKED) == MAG_CHECKED) {
+        payload.concat(",\"magnetometerX\":");
+        payload.concat(String(r->mag[0]));
+        payload.concat(",\"magnetometerY\":");
+        payload.concat(String(r->mag[1]));
+        payload.concat(",\"magnetometerZ\":");
+        payload.concat(String(r->mag[2]));
+    }
+    if ((telemetryState & ACCEL_CHECKED) == ACCEL_CHECKED) {
+        payload.concat(",\"accelerometerX\":");
+        payload.concat(String(r->accel[0]));
+        payload.concat(",\"accelerometerY\":");
+        payload.concat(String(r->accel[1]));
+        payload.concat(",\"accelerometerZ\":");
+        payload.concat(String(r->accel[2]));
+    }
+    if ((telemetryState & GYRO_CHECKED) == GYRO_CHECKED) {
+        payload.concat(",\"gyroscopeX\":");
+        payload.concat(String(r->gyro[0]));
+        payload.concat(",\"gyroscopeY\":");
+        payload.concat(String(r->gyro[1]));
+        payload.concat(",\"gyroscopeZ\":");
+        payload.concat(String(r->gyro[2]));
+    }
+
+    payload.concat("}");
+    payload.replace("{,", "{");
+    return payload;
+}
+
+// the same fields written the way buildTelemetryPayload writes them
+static int writerPayload(uint8_t telemetryState, const READINGS *r, char *payload, int size) {
+    JSON_WRITER writer;
+    jsonWriterInit(&writer, payload, size);
+    jsonWriterBeginObject(&writer, NULL);
+
+    if ((telemetryState & HUMIDITY_CHECKED) == HUMIDITY_CHECKED) {
+        jsonWriterAddFloat(&writer, "humidity", r->humidity);
+    }
+    if ((telemetryState & TEMP_CHECKED) == TEMP_CHECKED) {
+        jsonWriterAddFloat(&writer, "temp", r->temp);
+    }
+    if ((telemetryState & PRESSURE_CHECKED) == PRESSURE_CHECKED) {
+        jsonWriterAddFloat(&writer, "pressure", r->pressure);
+    }
+    if ((telemetryState & MAG_CHECKED) == MAG_CHECKED) {
+        jsonWriterAddInt(&writer, "magnetometerX", r->mag[0]);
+        jsonWriterAddInt(&writer, "magnetometerY", r->mag[1]);
+        jsonWriterAddInt(&writer, "magnetometerZ", r->mag[2]);
+    }
+    if ((telemetryState & ACCEL_CHECKED) == ACCEL_CHECKED) {
+        jsonWriterAddInt(&writer, "accelerometerX", r->accel[0]);
+        jsonWriterAddInt(&writer, "accelerometerY", r->accel[1]);
+        jsonWriterAddInt(&writer, "accelerometerZ", r->accel[2]);
+    }
+    if ((telemetryState & GYRO_CHECKED) == GYRO_CHECKED) {
+        jsonWriterAddInt(&writer, "gyroscopeX", r->gyro[0]);
+        jsonWriterAddInt(&writer, "gyroscopeY", r->gyro[1]);
+        jsonWriterAddInt(&writer, "gyroscopeZ", r->gyro[2]);
+    }
+
+    jsonWriterEndObject(&writer);
+    return jsonWriterOverflow(&writer) ? -1 : jsonWriterLength(&writer);
+}
+
+static void randomReadings(READINGS *r) {
+    r->humidity = (rand() % 100000) / 1000.0f;
+    r->temp = (rand() % 80000) / 1000.0f - 40.0f;
+    r->pressure = 800.0f + (rand() % 400000) / 1000.0f;
+    for (int i = 0; i < 3; i++) {
+        r->mag[i] = rand() % 4000 - 2000;
+        r->accel[i] = rand() % 4000 - 2000;
+        r->gyro[i] = rand() % 100000 - 50000;
+    }
+}
+
+static const uint8_t sensorFlags[] = { TEMP_CHECKED, HUMIDITY_CHECKED, PRESSURE_CHECKED, ACCEL_CHECKED, GYRO_CHECKED, MAG_CHECKED };
+
+static uint8_t maskState(int mask) {
+    uint8_t state = 0;
+    for (int bit = 0; bit < 6; bit++) {
+        if (mask & (1 << bit)) {
+            state |= sensorFlags[bit];
+        }
+    }
+    return state;
+}
+
+static void testMatchesStringPayload() {
+    // edge values first, then random readings for every sensor combination
+    READINGS edges[] = {
+        { 0.0f, 0.0f, 0.0f, { 0, 0, 0 }, { 0, 0, 0 }, { 0, 0, 0 } },
+        { 99.999f, -0.004f, 1013.25f, { -1, 1, 2147483647 }, { -2147483647, 65535, -65535 }, { 10, -10, 100 } },
+        { 0.005f, -39.995f, 1260.0f, { 0xFFFF, 0, 0 }, { 1, 2, 3 }, { -1, -2, -3 } },
+    };
+
+    int compared = 0;
+    srand(1);
+    for (int round = 0; round < 200; round++) {
+        READINGS readings;
+        if (round < 3) {
+            readings = edges[round];
+        } else {
+            randomReadings(&readings);
+        }
+
+        for (int mask = 0; mask < 64; mask++) {
+            uint8_t state = maskState(mask);
+            char payload[TELEMETRY_PAYLOAD_MAX];
+            String expected = stringPayload(state, &readings);
+            int length = writerPayload(state, &readings, payload, sizeof(payload));
+
+            CHECK_EQUAL_INT(expected.length(), length);
+            CHECK_EQUAL_TEXT(expected.c_str(), payload);
+            compared++;
+        }
+    }
+    printf("compared %d payloads byte for byte\n", compared);
+}
+
+static void testNestingAndEscaping() {
+    char buffer[128];
+    JSON_WRITER writer;
+
+    jsonWriterInit(&writer, buffer, sizeof(buffer));
+    jsonWriterBeginObject(&writer, NULL);
+    jsonWriterAddString(&writer, "text", "say \"hi\" \\ bye");
+    jsonWriterBeginArray(&writer, "list");
+    jsonWriterAddInt(&writer, NULL, 1);
+    jsonWriterBeginObject(&writer, NULL);
+    jsonWriterEndObject(&writer);
+    jsonWriterAddRaw(&writer, NULL, "true");
+    jsonWriterEndArray(&writer);
+    jsonWriterAddMembers(&writer, "{\"a\":1,\"b\":2}", 13);
+    jsonWriterAddMembers(&writer, "{}", 2);
+    jsonWriterEndObject(&writer);
+
+    CHECK(!jsonWriterOverflow(&writer));
+    CHECK_EQUAL_TEXT("{\"text\":\"say \\\"hi\\\" \\\\ bye\",\"list\":[1,{},true],\"a\":1,\"b\":2}", buffer);
+    CHECK_EQUAL_INT(strlen(buffer), jsonWriterLength(&writer));
+}
+
+// counters past INT_MAX stay positive
+static void testUnsigned() {
+    char buffer[64];
+    JSON_WRITER writer;
+
+    jsonWriterInit(&writer, buffer, sizeof(buffer));
+    jsonWriterBeginObject(&writer, NULL);
+    jsonWriterAddUnsigned(&writer, "count", 4294967295UL);
+    jsonWriterBeginArray(&writer, "histogram");
+    jsonWriterAddUnsigned(&writer, NULL, 2147483648UL);
+    jsonWriterAddUnsigned(&writer, NULL, 0);
+    jsonWriterEndArray(&writer);
+    jsonWriterEndObject(&writer);
+
+    CHECK(!jsonWriterOverflow(&writer));
+    CHECK_EQUAL_TEXT("{\"count\":4294967295,\"histogram\":[2147483648,0]}", buffer);
+}
+
+static void testOverflowAndTruncate() {
+    char buffer[16];
+    JSON_WRITER writer;
+
+    jsonWriterInit(&writer, buffer, sizeof(buffer));
+    jsonWriterBeginObject(&writer, NULL);
+    jsonWriterAddInt(&writer, "a", 1);
+    int mark = jsonWriterLength(&writer);
+    jsonWriterAddString(&writer, "long", "does not fit here");
+    CHECK(jsonWriterOverflow(&writer));
+    CHECK(strlen(buffer) < sizeof(buffer));
+
+    // dropping the value that did not fit leaves a usable writer
+    jsonWriterTruncate(&writer, mark);
+    CHECK(!jsonWriterOverflow(&writer));
+    jsonWriterEndObject(&writer);
+    CHECK_EQUAL_TEXT("{\"a\":1}", buffer);
+}
+
+static void benchmark() {
+    const int payloads = 20000;
+    READINGS readings;
+    char payload[TELEMETRY_PAYLOAD_MAX];
+    uint8_t state = maskState(63);
+    unsigned long bytes = 0;
+
+    srand(2);
+    randomReadings(&readings);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < payloads; i++) {
+        bytes += stringPayload(state, &readings).length();
+    }
+    double stringMicros = elapsedMicros(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < payloads; i++) {
+        bytes += writerPayload(state, &readings, payload, sizeof(payload));
+    }
+    double writerMicros = elapsedMicros(start);
+
+    printf("all sensors: String %.2f us/payload, writer %.2f us/payload (%lu bytes)\n",
+        stringMicros / payloads, writerMicros / payloads, bytes);
+}
+
+int main() {
+    testMatchesStringPayload();
+    testNestingAndEscaping();
+    testUnsigned();
+    testOverflowAndTruncate();
+    benchmark();
+    return testResult("jsonWriterTest");
+}
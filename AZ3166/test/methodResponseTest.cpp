@@ -0,0 +1,98 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/methodResponse.h"
+
+#include "hostHeap.h"
+#include "testing.h"
+
+static int jsonHandler(JsonObject& /* payload */, char *response, size_t responseSize) {
+    snprintf(response, responseSize, "{\"status\":\"ok\",\"cycles\":%d}", 3);
+    return 200;
+}
+
+static int textHandler(JsonObject& /* payload */, char *response, size_t responseSize) {
+    snprintf(response, responseSize, "rainbow \"started\"");
+    return 200;
+}
+
+static int silentHandler(JsonObject& /* payload */, char * /* response */, size_t /* responseSize */) {
+    return 204;
+}
+
+// writes past the arena, the response is cut at its end
+static int floodHandler(JsonObject& /* payload */, char *response, size_t responseSize) {
+    memset(response, 'x', responseSize);
+    return 500;
+}
+
+static const methodCallback handlers[] = { jsonHandler, textHandler, silentHandler, floodHandler };
+
+// what the SDK gets back, it frees the response after sending it
+static int callMethod(methodCallback handler, char *body, int bodySize) {
+    JsonObject payload;
+    unsigned char *response = NULL;
+    int responseSize = -1;
+
+    int status = methodResponseInvoke(handler, payload);
+    methodResponseToSdk(methodResponseText(), &response, &responseSize);
+    if (body != NULL) {
+        int length = responseSize < bodySize - 1 ? responseSize : bodySize - 1;
+        memcpy(body, response, length);
+        body[length] = 0;
+    }
+    free(response);
+    return status;
+}
+
+static void testResponseBodies() {
+    char body[METHOD_RESPONSE_MAX + 16];
+
+    CHECK_EQUAL_INT(200, callMethod(jsonHandler, body, sizeof(body)));
+    CHECK_EQUAL_TEXT("{\"status\":\"ok\",\"cycles\":3}", body);
+
+    CHECK_EQUAL_INT(200, callMethod(textHandler, body, sizeof(body)));
+    CHECK_EQUAL_TEXT("\"rainbow \\\"started\\\"\"", body);
+
+    // a handler without a response still sends a JSON body, not the previous response
+    CHECK_EQUAL_INT(204, callMethod(silentHandler, body, sizeof(body)));
+    CHECK_EQUAL_TEXT("{}", body);
+
+    // the arena holds METHOD_RESPONSE_MAX - 1 characters, quoted they no longer fit
+    CHECK_EQUAL_INT(500, callMethod(floodHandler, body, sizeof(body)));
+    CHECK_EQUAL_INT(METHOD_RESPONSE_MAX - 1, (int)strlen(methodResponseText()));
+    CHECK_EQUAL_TEXT("{}", body);
+
+    methodResponseSet("{\"status\":\"method not found\"}");
+    CHECK_EQUAL_TEXT("{\"status\":\"method not found\"}", methodResponseText());
+}
+
+// every call hands one allocation to the SDK and the SDK frees it, so the heap stays flat
+static void soakHundredThousandCalls() {
+    const int calls = 100000;
+
+    callMethod(jsonHandler, NULL, 0);
+    long long heapBefore = hostHeapInUse();
+    unsigned long allocationsBefore = hostHeapAllocations();
+    hostHeapResetPeak();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < calls; i++) {
+        callMethod(handlers[i % 4], NULL, 0);
+    }
+    double micros = elapsedMicros(start);
+
+    CHECK_EQUAL_INT(heapBefore, hostHeapInUse());
+    CHECK_EQUAL_INT(calls, hostHeapAllocations() - allocationsBefore);
+    CHECK(hostHeapPeak() - heapBefore <= METHOD_RESPONSE_MAX + 16);
+    printf("%d method calls: %.2f us each, heap %lld bytes before and %lld after, peak %lld above\n",
+        calls, micros / calls, heapBefore, hostHeapInUse(), hostHeapPeak() - heapBefore);
+}
+
+int main() {
+    testResponseBodies();
+    soakHundredThousandCalls();
+    return testResult("methodResponseTest");
+}
@@ -0,0 +1,330 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/oledAnimation.h"
+#include "../inc/animationFrameData.h"
+#include "../inc/displayCache.h"
+
+#include "hostHeap.h"
+#include "testing.h"
+
+// the glyphs and if/else chain renderNextFrame composed every frame with before the
+// 256-entry table and then the frames packed by tools/packFrames.py replaced them
+static const unsigned char block[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+static const unsigned char blockGap[] = {0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E};
+static const unsigned char blockVGap[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00};
+static const unsigned char cross[] = {0x81, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42, 0x81};
+static const unsigned char diagLR[] = {0x03, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xC0};
+static const unsigned char diagRL[] = {0xC0, 0xE0, 0x70, 0x38, 0x1C, 0x0E, 0x07, 0x03};
+static const unsigned char horzT[] = {0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80};
+static const unsigned char horzB[] = {0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01};
+static const unsigned char vertL[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF};
+static const unsigned char vertR[] = {0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const unsigned char circle[] = {0x18, 0x7E, 0x7E, 0xFF, 0xFF, 0x7E, 0x7E, 0x18};
+static const unsigned char clear[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const unsigned char borderTop[] = {0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03};
+static const unsigned char borderBottom[] = {0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0};
+static const unsigned char borderLeft[] = {0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+static const unsigned char borderRight[] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF};
+static const unsigned char cornerLT[] = {0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03};
+static const unsigned char cornerRT[] = {0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFF, 0xFF};
+static const unsigned char cornerLB[] = {0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0};
+static const unsigned char cornerRB[] = {0xC0, 0x00, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF};
+static const unsigned char circleLT[] = {0x00, 0xF0, 0xF8, 0xFC, 0xFC, 0xFE, 0xFE, 0xFE};
+static const unsigned char circleRT[] = {0xFE, 0xFE, 0xFE, 0xFC, 0xFC, 0xF8, 0xF0, 0x00};
+static const unsigned char circleLB[] = {0x00, 0x0F, 0x1F, 0x3F, 0x3F, 0x7F, 0x7F, 0x7F};
+static const unsigned char circleRB[] = {0x7F, 0x7F, 0x7F, 0x3F, 0x3F, 0x1F, 0x0F, 0x00};
+
+static void composeIfChain(const char *image, unsigned char *buf) {
+    int columnPad = 3;
+    int colLimit = ANIMATION_FRAME_WIDTH / 8;
+    memset(buf, 0x00, ANIMATION_FRAME_BYTES);
+
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < colLimit; x++) {
+            if (image[(y * colLimit) + x] == 'B')
+                memcpy(buf + columnPad, block, 8);
+            else if (image[(y * colLimit) + x] == 'G')
+                memcpy(buf + columnPad, blockGap, 8);
+            else if (image[(y * colLimit) + x] == 'g')
+                memcpy(buf + columnPad, blockVGap, 8);
+            else if (image[(y * colLimit) + x] == 'X')
+                memcpy(buf + columnPad, cross, 8);
+            else if (image[(y * colLimit) + x] == 'L')
+                memcpy(buf + columnPad, diagLR, 8);
+            else if (image[(y * colLimit) + x] == 'R')
+                memcpy(buf + columnPad, diagRL, 8);
+            else if (image[(y * colLimit) + x] == 'H')
+                memcpy(buf + columnPad, horzT, 8);
+            else if (image[(y * colLimit) + x] == 'h')
+                memcpy(buf + columnPad, horzB, 8);
+            else if (image[(y * colLimit) + x] == 'V')
+                memcpy(buf + columnPad, vertL, 8);
+            else if (image[(y * colLimit) + x] == 'v')
+                memcpy(buf + columnPad, vertR, 8);
+            else if (image[(y * colLimit) + x] == 'O')
+                memcpy(buf + columnPad, circle, 8);
+            else if (image[(y * colLimit) + x] == '.')
+                memcpy(buf + columnPad, clear, 8);
+            else if (image[(y * colLimit) + x] == 'T')
+                memcpy(buf + columnPad, borderTop, 8);
+            else if (image[(y * colLimit) + x] == 'b')
+                memcpy(buf + columnPad, borderBottom, 8);
+            else if (image[(y * colLimit) + x] == '<')
+                memcpy(buf + columnPad, borderLeft, 8);
+            else if (image[(y * colLimit) + x] == '>')
+                memcpy(buf + columnPad, borderRight, 8);
+            else if (image[(y * colLimit) + x] == '1')
+                memcpy(buf + columnPad, cornerLT, 8);
+            else if (image[(y * colLimit) + x] == '2')
+                memcpy(buf + columnPad, cornerRT, 8);
+            else if (image[(y * colLimit) + x] == '3')
+                memcpy(buf + columnPad, cornerLB, 8);
+            else if (image[(y * colLimit) + x] == '4')
+                memcpy(buf + columnPad, cornerRB, 8);
+            else if (image[(y * colLimit) + x] == '!')
+                memcpy(buf + columnPad, circleLT, 8);
+            else if (image[(y * colLimit) + x] == '@')
+                memcpy(buf + columnPad, circleRT, 8);
+            else if (image[(y * colLimit) + x] == '#')
+                memcpy(buf + columnPad, circleLB, 8);
+            else if (image[(y * colLimit) + x] == '$')
+                memcpy(buf + columnPad, circleRB, 8);
+
+            columnPad = columnPad + 8;
+        }
+        columnPad = columnPad + 8;
+    }
+}
+
+// the 256-entry glyph table, unknown characters render blank
+static const unsigned char *glyphTable[256];
+
+static void initGlyphTable() {
+    static const char codes[] = "BGgXLRHhVvO.Tb<>1234!@#$";
+    static const unsigned char *bitmaps[] = { block, blockGap, blockVGap, cross, diagLR, diagRL,
+        horzT, horzB, vertL, vertR, circle, clear, borderTop, borderBottom, borderLeft, borderRight,
+        cornerLT, cornerRT, cornerLB, cornerRB, circleLT, circleRT, circleLB, circleRB };
+
+    for (int i = 0; i < 256; i++) {
+        glyphTable[i] = clear;
+    }
+    for (int i = 0; codes[i] != 0; i++) {
+        glyphTable[(unsigned char)codes[i]] = bitmaps[i];
+    }
+}
+
+static void composeTable(const char *image, unsigned char *buf) {
+    memset(buf, 0x00, ANIMATION_FRAME_BYTES);
+    unsigned char *cell = buf + 3;
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < ANIMATION_FRAME_WIDTH / 8; x++) {
+            memcpy(cell, glyphTable[(unsigned char)*image++], 8);
+            cell = cell + 8;
+        }
+        cell = cell + 8;
+    }
+}
+
+typedef struct PACKED_FRAME_TAG {
+    const char *name;
+    const unsigned char *frame;
+} PACKED_FRAME;
+
+static const PACKED_FRAME packedFrames[] = {
+    { "fan1", fan1Frame }, { "fan2", fan2Frame },
+    { "voltage0", voltage0Frame }, { "voltage1", voltage1Frame }, { "voltage2", voltage2Frame },
+    { "voltage3", voltage3Frame }, { "voltage4", voltage4Frame },
+    { "current0", current0Frame }, { "current1", current1Frame }, { "current2", current2Frame },
+    { "current3", current3Frame }, { "current4", current4Frame },
+    { "die1", die1Frame }, { "die2", die2Frame }, { "die3", die3Frame },
+    { "die4", die4Frame }, { "die5", die5Frame }, { "die6", die6Frame }
+};
+
+#define PACKED_FRAME_COUNT (int)(sizeof(packedFrames) / sizeof(packedFrames[0]))
+
+// the ASCII frames of tools/animationFrames.txt, in the order of the file
+static char asciiNames[PACKED_FRAME_COUNT][16];
+static char asciiFrames[PACKED_FRAME_COUNT][64];
+static int asciiCount = 0;
+
+static void readAsciiFrames() {
+    FILE *file = fopen(ANIMATION_FRAMES_TXT, "r");
+    CHECK(file != NULL);
+    if (file == NULL) {
+        return;
+    }
+
+    char line[64];
+    int rows = 0;
+    while (fgets(line, sizeof(line), file) != NULL) {
+        line[strcspn(line, "\r\n")] = 0;
+        if (line[0] == 0 || line[0] == '#') {
+            continue;
+        }
+        if (line[0] == '[') {
+            CHECK(asciiCount < PACKED_FRAME_COUNT);
+            if (asciiCount == PACKED_FRAME_COUNT) {
+                break;
+            }
+            snprintf(asciiNames[asciiCount], sizeof(asciiNames[0]), "%.*s", (int)strlen(line) - 2, line + 1);
+            asciiCount++;
+            rows = 0;
+        } else if (asciiCount > 0 && rows < 8 && strlen(line) == 8) {
+            memcpy(&asciiFrames[asciiCount - 1][rows * 8], line, 8);
+            rows++;
+        }
+    }
+    fclose(file);
+}
+
+// the checked in frames are byte for byte what the old renderer built from the ASCII art
+static void testPackedFramesMatchRenderer() {
+    unsigned char chain[ANIMATION_FRAME_BYTES];
+    unsigned char table[ANIMATION_FRAME_BYTES];
+
+    CHECK_EQUAL_INT(PACKED_FRAME_COUNT, asciiCount);
+    for (int i = 0; i < asciiCount; i++) {
+        CHECK_EQUAL_TEXT(packedFrames[i].name, asciiNames[i]);
+        composeIfChain(asciiFrames[i], chain);
+        composeTable(asciiFrames[i], table);
+        CHECK(memcmp(chain, packedFrames[i].frame, ANIMATION_FRAME_BYTES) == 0);
+        CHECK(memcmp(table, packedFrames[i].frame, ANIMATION_FRAME_BYTES) == 0);
+    }
+}
+
+// every tick of animationTask draws the next packed frame as it is stored
+static void testAnimationDrawsPackedFrames() {
+    const unsigned char *frames[] = { fan1Frame, fan2Frame };
+    Screen.reset();
+    hostSetMillis(1000);
+
+    CHECK(animationStart(frames, 2, 3, 0, 100, true));
+    CHECK(animationRunning());
+    animationTask();
+    CHECK(Screen.lastBitmap == fan1Frame);
+    hostAdvanceMillis(99);
+    animationTask();
+    CHECK_EQUAL_INT(1, Screen.draws);
+    hostAdvanceMillis(1);
+    animationTask();
+    CHECK(Screen.lastBitmap == fan2Frame);
+    hostAdvanceMillis(100);
+    animationTask();
+    CHECK(Screen.lastBitmap == fan1Frame);
+    CHECK_EQUAL_INT(3, Screen.draws);
+
+    // the last frame stays up for one interval, then the info pages get the screen back
+    hostAdvanceMillis(100);
+    animationTask();
+    CHECK(!animationRunning());
+    CHECK_EQUAL_INT(3, Screen.draws);
+}
+
+// fan, voltage, current and die commands, started over each other, run out or cancelled,
+// never touch the heap
+static void testCommandsDoNotAllocate() {
+    const int commands = 5000;
+    const unsigned char *fan[] = { fan1Frame, fan2Frame };
+    const unsigned char *voltage[] = { voltage0Frame, voltage1Frame, voltage2Frame, voltage3Frame, voltage4Frame,
+        voltage3Frame, voltage2Frame, voltage1Frame, voltage0Frame };
+    const unsigned char *die[] = { die1Frame, die2Frame, die3Frame, die4Frame, die5Frame, die6Frame };
+
+    Screen.reset();
+    hostSetMillis(1000);
+    long long heapBefore = hostHeapInUse();
+    unsigned long allocationsBefore = hostHeapAllocations();
+
+    for (int i = 0; i < commands; i++) {
+        switch (i % 4) {
+            case 0:
+                animationStart(fan, 2, 10, 0, 20, true);
+                break;
+            case 1:
+                animationStart(voltage, 9, 9, 0, 10, true);
+                break;
+            case 2:
+                animationStart(voltage, 9, 9, 0, 10, false);
+                break;
+            case 3:
+                animationStart(die, 5, 5, 0, 5, true);
+                break;
+        }
+        // some run to the end, some are replaced or cancelled part way
+        for (int tick = 0; tick < (i % 7) * 10; tick++) {
+            animationTask();
+            hostAdvanceMillis(5);
+        }
+        if (i % 5 == 0) {
+            animationCancel();
+            animationTask();
+        }
+    }
+    animationCancel();
+    animationTask();
+
+    CHECK(!animationRunning());
+    CHECK(Screen.draws > (unsigned long)commands);
+    CHECK_EQUAL_INT(0, hostHeapAllocations() - allocationsBefore);
+    CHECK_EQUAL_INT(heapBefore, hostHeapInUse());
+    printf("%d animation commands, %lu frames: %lu allocations, %lld bytes net\n",
+        commands, Screen.draws, hostHeapAllocations() - allocationsBefore, hostHeapInUse() - heapBefore);
+}
+
+// the draw calls go through a pointer so the compiler cannot drop or hoist the composing
+typedef void (*composeFunction)(const char *image, unsigned char *buf);
+
+static void composeAndDraw(composeFunction compose, int frameCount) {
+    static unsigned char buf[ANIMATION_FRAME_BYTES];
+    for (int i = 0; i < frameCount; i++) {
+        compose(asciiFrames[i % asciiCount], buf);
+        Screen.draw(31, 0, 103, 8, buf);
+    }
+}
+
+// frames per second of the host CPU composing and handing frames to the (stubbed) panel,
+// the I2C transfer itself is the same for all three
+static void benchmark() {
+    const int frameCount = 200000;
+    volatile composeFunction chain = composeIfChain;
+    volatile composeFunction table = composeTable;
+    const unsigned char *frames[PACKED_FRAME_COUNT];
+    for (int i = 0; i < PACKED_FRAME_COUNT; i++) {
+        frames[i] = packedFrames[i].frame;
+    }
+
+    Screen.reset();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    composeAndDraw(chain, frameCount);
+    double chainMicros = elapsedMicros(start);
+
+    start = std::chrono::steady_clock::now();
+    composeAndDraw(table, frameCount);
+    double tableMicros = elapsedMicros(start);
+
+    hostSetMillis(1000);
+    animationStart(frames, ANIMATION_MAX_FRAMES, frameCount, 0, 0, true);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frameCount; i++) {
+        animationTask();
+    }
+    double packedMicros = elapsedMicros(start);
+    animationCancel();
+    animationTask();
+
+    CHECK_EQUAL_INT(3 * frameCount, Screen.draws);
+    printf("frames/sec: if/else chain %.0f, glyph table %.0f, packed frames %.0f\n",
+        frameCount * 1e6 / chainMicros, frameCount * 1e6 / tableMicros, frameCount * 1e6 / packedMicros);
+}
+
+int main() {
+    initGlyphTable();
+    readAsciiFrames();
+    testPackedFramesMatchRenderer();
+    testAnimationDrawsPackedFrames();
+    testCommandsDoNotAllocate();
+    benchmark();
+    return testResult("oledAnimationTest");
+}
@@ -0,0 +1,206 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+
+#include "../inc/outboundWorker.h"
+#include "../inc/iotHubClient.h"
+#include "../inc/telemetryQueue.h"
+#include "../inc/stats.h"
+
+#include "testing.h"
+
+// stand-ins for the hub client, the worker loop ends once stopAt is reached or
+// stopAfterSent events went out
+static int failuresLeft = 0;
+static int attempts = 0;
+static unsigned long attemptTimes[32];
+static int eventsSent = 0;
+static int stopAfterSent = 0;
+static unsigned long stopAt = 0;
+
+bool sendTelemetry(const char * /* payload */, int /* length */, time_t /* timestamp */, TelemetryEncoding /* encoding */) {
+    if (attempts < 32) {
+        attemptTimes[attempts] = millis();
+    }
+    attempts++;
+
+    bool success = true;
+    if (failuresLeft != 0) {
+        if (failuresLeft > 0) {
+            failuresLeft--;
+        }
+        success = false;
+    } else {
+        eventsSent++;
+    }
+
+    if ((stopAfterSent > 0 && eventsSent >= stopAfterSent) || (stopAt > 0 && millis() >= stopAt)) {
+        stopOutboundWorker();
+    }
+    return success;
+}
+
+bool sendReportedProperty(const char * /* payload */) {
+    return true;
+}
+
+static int checks = 0;
+static int stopAfterChecks = 0;
+
+void checkIotHubClient() {
+    if (++checks == stopAfterChecks) {
+        stopOutboundWorker();
+    }
+}
+
+static int errorsReported = 0;
+static int samplesReported = 0;
+
+static void telemetryDone(int samples, bool success) {
+    if (success) {
+        samplesReported += samples;
+    } else {
+        errorsReported++;
+    }
+}
+
+static void reset() {
+    hostSetMillis(0);
+    telemetryQueueClear();
+    clearCounters();
+    setTelemetryBatching(1, 60000);
+    failuresLeft = 0;
+    attempts = 0;
+    eventsSent = 0;
+    stopAfterSent = 0;
+    stopAt = 0;
+    checks = 0;
+    stopAfterChecks = 0;
+    errorsReported = 0;
+    samplesReported = 0;
+}
+
+static void pushSamples(int samples) {
+    for (int i = 0; i < samples; i++) {
+        char payload[32];
+        int length = snprintf(payload, sizeof(payload), "{\"sample\":%d}", i);
+        telemetryQueuePush(payload, length, 1500000000 + i, TELEMETRY_JSON);
+    }
+}
+
+// an unreachable hub is retried with a doubling wait, the stuck record is one error
+static void testBackoffWhileOffline() {
+    reset();
+    pushSamples(1);
+    failuresLeft = -1;
+    stopAt = 300000;
+
+    startOutboundWorker(telemetryDone);
+
+    CHECK_EQUAL_INT(8, attempts);
+    CHECK_EQUAL_INT(1, errorsReported);
+    CHECK_EQUAL_INT(0, samplesReported);
+    CHECK_EQUAL_INT(1, telemetryQueueCount());
+
+    static const unsigned long expectedGaps[] = { 5000, 10000, 20000, 40000, 80000, 80000, 80000 };
+    for (int i = 1; i < attempts && i < 8; i++) {
+        unsigned long gap = attemptTimes[i] - attemptTimes[i - 1];
+        // the worker only looks at the queue every poll interval
+        CHECK(gap >= expectedGaps[i - 1] && gap < expectedGaps[i - 1] + 100);
+    }
+}
+
+// after the connection is back the queue drains and a later failure starts the wait over
+static void testRecoveryResetsBackoff() {
+    reset();
+    pushSamples(3);
+    failuresLeft = 2;
+    stopAfterSent = 3;
+
+    startOutboundWorker(telemetryDone);
+
+    CHECK_EQUAL_INT(5, attempts);
+    CHECK_EQUAL_INT(1, errorsReported);
+    CHECK_EQUAL_INT(3, samplesReported);
+    CHECK_EQUAL_INT(0, telemetryQueueCount());
+    CHECK(attemptTimes[2] - attemptTimes[1] >= 10000 && attemptTimes[2] - attemptTimes[1] < 10100);
+
+    reset();
+    hostSetMillis(500000);
+    pushSamples(1);
+    failuresLeft = 1;
+    stopAfterSent = 1;
+
+    startOutboundWorker(telemetryDone);
+
+    CHECK_EQUAL_INT(2, attempts);
+    CHECK(attemptTimes[1] - attemptTimes[0] < 5100);
+}
+
+// each failed record counts once, also when batched
+static void testBatchFailureCountedOnce() {
+    reset();
+    setTelemetryBatching(4, 60000);
+    pushSamples(4);
+    failuresLeft = 3;
+    stopAfterSent = 1;
+
+    startOutboundWorker(telemetryDone);
+
+    CHECK_EQUAL_INT(4, attempts);
+    CHECK_EQUAL_INT(1, errorsReported);
+    CHECK_EQUAL_INT(4, samplesReported);
+}
+
+// with nothing to send the hub client still gets to deliver commands and twin updates
+static void testIdlePollsCheckForInbound() {
+    reset();
+    setTelemetryBatching(4, 60000);
+    pushSamples(1);
+    stopAfterChecks = 10;
+
+    startOutboundWorker(telemetryDone);
+
+    // the held sample does not count as sending
+    CHECK_EQUAL_INT(0, attempts);
+    CHECK_EQUAL_INT(10, checks);
+    CHECK_EQUAL_INT(1000, millis());
+
+    // a poll that sent has already let the client work, the next idle one checks
+    reset();
+    pushSamples(3);
+    stopAfterChecks = 1;
+
+    startOutboundWorker(telemetryDone);
+
+    CHECK_EQUAL_INT(3, attempts);
+    CHECK_EQUAL_INT(1, checks);
+    CHECK_EQUAL_INT(200, millis());
+}
+
+// out of the box the samples go in batches, a short batch still goes once its oldest sample is old enough
+static void testDefaultBatching() {
+    reset();
+    setTelemetryBatching(TELEMETRY_BATCH_DEFAULT, TELEMETRY_BATCH_AGE_DEFAULT);
+    pushSamples(TELEMETRY_BATCH_DEFAULT + 1);
+    stopAfterSent = 2;
+
+    startOutboundWorker(telemetryDone);
+
+    CHECK_EQUAL_INT(2, attempts);
+    CHECK_EQUAL_INT(TELEMETRY_BATCH_DEFAULT + 1, samplesReported);
+    CHECK(attemptTimes[0] < 200);
+    CHECK(attemptTimes[1] >= TELEMETRY_BATCH_AGE_DEFAULT && attemptTimes[1] < TELEMETRY_BATCH_AGE_DEFAULT + 200);
+    CHECK(getBytesSavedPerSample() > 0);
+}
+
+int main() {
+    testBackoffWhileOffline();
+    testRecoveryResetsBackoff();
+    testBatchFailureCountedOnce();
+    testIdlePollsCheckForInbound();
+    testDefaultBatching();
+    return testResult("outboundWorkerTest");
+}
@@ -0,0 +1,162 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+
+#include "../inc/reportedProperties.h"
+#include "../inc/outboundWorker.h"
+#include "../inc/iotHubClient.h"
+#include "../inc/stats.h"
+
+#include "testing.h"
+
+// stand-ins for the hub client, the worker loop ends once the expected patches went out
+static char patches[REPORTED_POOL_DEPTH][OUTBOUND_PAYLOAD_MAX];
+static int patchesSent = 0;
+static int stopAfterPatches = 0;
+
+bool sendReportedProperty(const char *payload) {
+    if (patchesSent < REPORTED_POOL_DEPTH) {
+        snprintf(patches[patchesSent], OUTBOUND_PAYLOAD_MAX, "%s", payload);
+    }
+    if (++patchesSent >= stopAfterPatches) {
+        stopOutboundWorker();
+    }
+    return true;
+}
+
+bool sendTelemetry(const char * /* payload */, int /* length */, time_t /* timestamp */, TelemetryEncoding /* encoding */) {
+    return true;
+}
+
+void checkIotHubClient() {
+}
+
+static void reset() {
+    hostSetMillis(1000);
+    clearCounters();
+    setReportedPropertyWindow(0);
+    patchesSent = 0;
+}
+
+// lets the outbound worker send the queued patches
+static void deliver(int expectedPatches) {
+    stopAfterPatches = patchesSent + expectedPatches;
+    startOutboundWorker(NULL);
+}
+
+static int occurrences(const char *text, const char *find) {
+    int count = 0;
+    for (const char *p = strstr(text, find); p != NULL; p = strstr(p + 1, find)) {
+        count++;
+    }
+    return count;
+}
+
+// a full twin replayed after a reconnect echoes every property, in as few patches as fit
+static void testFullTwinCoalesced() {
+    const int properties = 12;
+    char names[properties][16];
+    reset();
+    int savedBefore = getReportedMessagesSaved();
+
+    for (int i = 0; i < properties; i++) {
+        snprintf(names[i], sizeof(names[i]), "setting%d", i);
+        reportDesiredProperty(names[i], "1234", 7, "completed", 200);
+    }
+    echoDesiredProperty();
+
+    // every property merged into a patch with others saved a message
+    deliver(properties - (getReportedMessagesSaved() - savedBefore));
+
+    printf("full twin of %d properties: %d STATE messages instead of %d\n", properties, patchesSent, properties);
+    CHECK(patchesSent < properties / 2);
+    CHECK_EQUAL_INT(properties, getReportedCount());
+    CHECK_EQUAL_INT(0, getErrorCount());
+
+    int members = 0;
+    for (int i = 0; i < patchesSent; i++) {
+        CHECK(strlen(patches[i]) < OUTBOUND_PAYLOAD_MAX);
+        members += occurrences(patches[i], "\"desiredVersion\":7");
+    }
+    CHECK_EQUAL_INT(properties, members);
+    for (int i = 0; i < properties; i++) {
+        char key[sizeof(names[i]) + 4];
+        snprintf(key, sizeof(key), "\"%.*s\":", (int)sizeof(names[i]) - 1, names[i]);
+        int found = 0;
+        for (int p = 0; p < patchesSent; p++) {
+            found += occurrences(patches[p], key);
+        }
+        CHECK_EQUAL_INT(1, found);
+    }
+}
+
+// within the window a later value of a property replaces the earlier one
+static void testLaterValueWins() {
+    reset();
+    setReportedPropertyWindow(1000);
+    int savedBefore = getReportedMessagesSaved();
+
+    reportDesiredProperty("fanSpeed", "100", 1, "completed", 200);
+    echoDesiredProperty();
+    hostAdvanceMillis(500);
+    reportDesiredProperty("fanSpeed", "300", 2, "completed", 200);
+    reportDesiredProperty("irOn", "true", 2, "completed", 200);
+    echoDesiredProperty();
+    hostAdvanceMillis(499);
+    echoDesiredProperty();
+    CHECK_EQUAL_INT(0, patchesSent);
+
+    hostAdvanceMillis(1);
+    echoDesiredProperty();
+    deliver(1);
+
+    CHECK_EQUAL_INT(1, patchesSent);
+    CHECK_EQUAL_TEXT("{\"fanSpeed\":{\"value\":300,\"statusCode\":200,\"status\":\"completed\",\"desiredVersion\":2},"
+        "\"irOn\":{\"value\":true,\"statusCode\":200,\"status\":\"completed\",\"desiredVersion\":2}}", patches[0]);
+    // the acknowledgements count the properties in the patch, not the changes merged into them
+    CHECK_EQUAL_INT(2, getReportedCount());
+    CHECK_EQUAL_INT(2, getReportedMessagesSaved() - savedBefore);
+}
+
+// more changes than records are dropped and counted, the pool is whole again after the flush
+static void testPoolExhausted() {
+    char name[16];
+    reset();
+    int savedBefore = getReportedMessagesSaved();
+
+    for (int i = 0; i <= REPORTED_POOL_DEPTH; i++) {
+        snprintf(name, sizeof(name), "p%d", i);
+        reportDesiredProperty(name, "1", 3, "completed", 200);
+    }
+    CHECK_EQUAL_INT(REPORTED_POOL_DEPTH, getReportedPoolHighWater());
+    CHECK_EQUAL_INT(1, getReportedPoolExhausted());
+    CHECK_EQUAL_INT(1, getErrorCount());
+
+    echoDesiredProperty();
+    int expectedPatches = REPORTED_POOL_DEPTH - (getReportedMessagesSaved() - savedBefore);
+    deliver(expectedPatches);
+    CHECK_EQUAL_INT(expectedPatches, patchesSent);
+    CHECK_EQUAL_INT(REPORTED_POOL_DEPTH, getReportedCount());
+
+    reportDesiredProperty("again", "1", 4, "completed", 200);
+    CHECK_EQUAL_INT(1, getReportedPoolExhausted());
+
+    // the getDeviceStats method reports the same pool use
+    char stats[128];
+    char expected[128];
+    int length = buildReportedStatsJson(stats, sizeof(stats));
+    snprintf(expected, sizeof(expected), "{\"poolDepth\":%d,\"poolHighWater\":%d,\"poolExhausted\":1,\"messagesSaved\":%d}",
+        REPORTED_POOL_DEPTH, REPORTED_POOL_DEPTH, getReportedMessagesSaved());
+    CHECK_EQUAL_TEXT(expected, stats);
+    CHECK_EQUAL_INT((int)strlen(expected), length);
+    CHECK_EQUAL_INT(-1, buildReportedStatsJson(stats, 16));
+}
+
+int main() {
+    testFullTwinCoalesced();
+    testLaterValueWins();
+    testPoolExhausted();
+    return testResult("reportedPropertiesTest");
+}
@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/scheduler.h"
+
+#include "testing.h"
+
+// the scheduler runs on a simulated clock, tasks advance it to stand in for their run time
+static unsigned long simulatedTime = 0;
+static unsigned long simulatedClock() {
+    return simulatedTime;
+}
+
+static char order[64];
+static int orderLength = 0;
+static unsigned long slowRunTime = 0;
+
+static void mark(char c) {
+    if (orderLength < (int)sizeof(order) - 1) {
+        order[orderLength++] = c;
+        order[orderLength] = 0;
+    }
+}
+
+static void fastTask() {
+    mark('f');
+}
+
+static void slowTask() {
+    mark('s');
+    simulatedTime += slowRunTime;
+}
+
+static void otherTask() {
+    mark('o');
+}
+
+static void reset() {
+    simulatedTime = 1000;
+    orderLength = 0;
+    order[0] = 0;
+    slowRunTime = 0;
+    schedulerInit(simulatedClock);
+}
+
+static void testRunsDueTasksEarliestDeadlineFirst() {
+    reset();
+    schedulerAddTask("slow", slowTask, 30);
+    schedulerAddTask("fast", fastTask, 10);
+    schedulerAddTask("other", otherTask, 20);
+
+    schedulerRun();
+    CHECK_EQUAL_TEXT("", order);
+
+    simulatedTime += 30;
+    schedulerRun();
+    CHECK_EQUAL_TEXT("fos", order);
+
+    // fast missed a whole period in the first pass so it restarts from then, due with other again
+    simulatedTime += 10;
+    schedulerRun();
+    CHECK_EQUAL_TEXT("fosfo", order);
+}
+
+static void testStatsAndJitter() {
+    reset();
+    int fast = schedulerAddTask("fast", fastTask, 10);
+
+    for (int i = 0; i < 100; i++) {
+        simulatedTime += (i % 2 == 0) ? 13 : 7;
+        schedulerRun();
+    }
+
+    TASK_STATS stats;
+    CHECK(schedulerGetStats(fast, &stats));
+    CHECK_EQUAL_TEXT("fast", stats.name);
+    CHECK_EQUAL_INT(100, stats.runs);
+    CHECK_EQUAL_INT(10, stats.period);
+    CHECK_EQUAL_INT(3, stats.maxJitter);
+    CHECK_EQUAL_INT(0, stats.overruns);
+    CHECK(!schedulerGetStats(fast + 1, &stats));
+
+    schedulerClearStats();
+    CHECK(schedulerGetStats(fast, &stats));
+    CHECK_EQUAL_INT(0, stats.runs);
+    CHECK_EQUAL_INT(0, stats.maxJitter);
+}
+
+// a task running longer than its period is counted and rescheduled from now, not run back to back
+static void testOverrunReschedulesFromNow() {
+    reset();
+    int slow = schedulerAddTask("slow", slowTask, 10);
+    slowRunTime = 35;
+
+    simulatedTime += 10;
+    schedulerRun();
+    simulatedTime += 5;
+    schedulerRun();
+
+    TASK_STATS stats;
+    schedulerGetStats(slow, &stats);
+    CHECK_EQUAL_INT(1, stats.runs);
+    CHECK_EQUAL_INT(1, stats.overruns);
+    CHECK_EQUAL_INT(35, stats.maxRunTime);
+
+    slowRunTime = 0;
+    simulatedTime += 5;
+    schedulerRun();
+    schedulerGetStats(slow, &stats);
+    CHECK_EQUAL_INT(2, stats.runs);
+}
+
+static void testSetPeriodTakesEffectNow() {
+    reset();
+    int fast = schedulerAddTask("fast", fastTask, 1000);
+    schedulerSetPeriod(fast, 10);
+
+    simulatedTime += 10;
+    schedulerRun();
+    CHECK_EQUAL_TEXT("f", order);
+}
+
+static void testTaskLimit() {
+    reset();
+    for (int i = 0; i < SCHEDULER_MAX_TASKS; i++) {
+        CHECK_EQUAL_INT(i, schedulerAddTask("task", fastTask, 10));
+    }
+    CHECK_EQUAL_INT(-1, schedulerAddTask("extra", fastTask, 10));
+    CHECK_EQUAL_INT(SCHEDULER_MAX_TASKS, schedulerTaskCount());
+}
+
+// the stats of the firmware's task set must fit the 1024 byte method response
+static void testStatsJsonFitsMethodResponse() {
+    static const char *names[] = { "leds", "methodJobs", "inbound", "buttons", "twinEcho", "shake",
+        "sampling", "telemetry", "animation", "display", "timeSync" };
+    reset();
+    for (int i = 0; i < 11; i++) {
+        schedulerAddTask(names[i], fastTask, 100000);
+    }
+    simulatedTime += 100000;
+    schedulerRun();
+
+    char buffer[1024];
+    int length = buildSchedulerStatsJson(buffer, sizeof(buffer));
+    CHECK(length > 0);
+    CHECK(strstr(buffer, "{\"fields\":[\"period\",\"runs\",") == buffer);
+    CHECK(strstr(buffer, "\"timeSync\":[100000,1,0,0,0,0]") != NULL);
+
+    // seven digit jitter on every task
+    for (int i = 0; i < 11; i++) {
+        schedulerSetPeriod(i, 10);
+    }
+    for (int i = 0; i < 300; i++) {
+        simulatedTime += 9999991;
+        schedulerRun();
+    }
+    length = buildSchedulerStatsJson(buffer, sizeof(buffer));
+    printf("scheduler stats for 11 tasks: %d bytes\n", length);
+    CHECK(length > 0 && length < (int)sizeof(buffer));
+}
+
+int main() {
+    testRunsDueTasksEarliestDeadlineFirst();
+    testStatsAndJitter();
+    testOverrunReschedulesFromNow();
+    testSetPeriodTakesEffectNow();
+    testTaskLimit();
+    testStatsJsonFitsMethodResponse();
+    return testResult("schedulerTest");
+}
@@ -0,0 +1,125 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/config.h"
+#include "../inc/sensors.h"
+#include "../inc/sensorSampler.h"
+
+#include "testing.h"
+
+// stand-ins for the sensor readers, the HTS221 converts once a second like the chip
+static unsigned long hts221ReadTime = 0;
+static float humidityReading = 40.0f;
+static int humidityReads = 0;
+
+float readHumidity() {
+    if (hts221ReadTime == 0 || millis() - hts221ReadTime >= 1000) {
+        hts221ReadTime = millis();
+        humidityReading += 1.0f;
+    }
+    humidityReads++;
+    return humidityReading;
+}
+
+float readTemperature() {
+    return humidityReading - 20.0f;
+}
+
+unsigned long getHumidityTemperatureTime() {
+    return hts221ReadTime;
+}
+
+float readPressure() {
+    return 1000.0f + (millis() % 1000) / 100.0f;
+}
+
+void readMagnetometer(int *axes) {
+    axes[0] = 1;
+    axes[1] = 2;
+    axes[2] = 3;
+}
+
+void readAccelerometer(int *axes) {
+    readMagnetometer(axes);
+}
+
+void readGyroscope(int *axes) {
+    readMagnetometer(axes);
+}
+
+bool isMotionFifoEnabled() {
+    return false;
+}
+
+int drainMotionFifo() {
+    return 0;
+}
+
+bool takeMotionSample(MOTION_SAMPLE * /* sample */) {
+    return false;
+}
+
+// 100 ms samples over a 5 s window take five HTS221 conversions, not fifty copies of them
+static void testCachedReadingsCountedOnce() {
+    CHANNEL_AGGREGATE window[CHANNEL_COUNT];
+    hostSetMillis(1);
+    clearAggregates();
+
+    for (int i = 0; i < 50; i++) {
+        sampleSensors(0xFF);
+        hostAdvanceMillis(100);
+    }
+    takeAggregates(window);
+
+    CHECK_EQUAL_INT(50, humidityReads);
+    CHECK_EQUAL_INT(5, window[CHANNEL_HUMIDITY].count);
+    CHECK_EQUAL_INT(5, window[CHANNEL_TEMP].count);
+    CHECK_EQUAL_INT(50, window[CHANNEL_PRESSURE].count);
+    CHECK(fabsf(window[CHANNEL_HUMIDITY].mean - 43.0f) < 0.001f);
+    CHECK(fabsf(window[CHANNEL_HUMIDITY].min - 41.0f) < 0.001f);
+    CHECK(fabsf(window[CHANNEL_HUMIDITY].max - 45.0f) < 0.001f);
+    CHECK(fabsf(aggregateStdDev(&window[CHANNEL_HUMIDITY]) - sqrtf(2.0f)) < 0.001f);
+
+    // a window shorter than a conversion still gets the cached reading once
+    sampleSensors(0xFF);
+    sampleSensors(0xFF);
+    takeAggregates(window);
+    CHECK_EQUAL_INT(1, window[CHANNEL_HUMIDITY].count);
+    CHECK_EQUAL_INT(1, window[CHANNEL_TEMP].count);
+    CHECK_EQUAL_INT(2, window[CHANNEL_PRESSURE].count);
+}
+
+// Welford against a two pass mean and deviation, error values stay out of the window
+static void testWelfordMatchesTwoPass() {
+    CHANNEL_AGGREGATE window[CHANNEL_COUNT];
+    float values[1000];
+    double sum = 0;
+
+    clearAggregates();
+    srand(3);
+    for (int i = 0; i < 1000; i++) {
+        values[i] = 1013.0f + (rand() % 2000) / 1000.0f;
+        sum += values[i];
+        addSample(CHANNEL_PRESSURE, values[i]);
+        addSample(CHANNEL_PRESSURE, 0xFFFF);
+    }
+    takeAggregates(window);
+
+    double mean = sum / 1000;
+    double m2 = 0;
+    for (int i = 0; i < 1000; i++) {
+        m2 += (values[i] - mean) * (values[i] - mean);
+    }
+
+    CHECK_EQUAL_INT(1000, window[CHANNEL_PRESSURE].count);
+    CHECK(fabs(window[CHANNEL_PRESSURE].mean - mean) < 0.001);
+    CHECK(fabs(aggregateStdDev(&window[CHANNEL_PRESSURE]) - sqrt(m2 / 1000)) < 0.001);
+}
+
+int main() {
+    testCachedReadingsCountedOnce();
+    testWelfordMatchesTwoPass();
+    return testResult("sensorSamplerTest");
+}
@@ -0,0 +1,141 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "DevI2C.h"
+#include "LSM6DSLSensor.h"
+
+#include "../inc/sensors.h"
+#include "../inc/sensorStats.h"
+#include "../inc/methodResponse.h"
+
+#include "testing.h"
+
+// takes every register write, enough for the FIFO capture to start
+class AcceptingDevice : public HostI2cDevice {
+public:
+    int read(uint8_t /* reg */, uint8_t *data, uint16_t length) {
+        memset(data, 0, length);
+        return 0;
+    }
+    int write(uint8_t /* reg */, const uint8_t * /* data */, uint16_t /* length */) {
+        return 0;
+    }
+};
+
+// a read of the given length on the host clock
+static void timedRead(int reader, unsigned long micros, bool error) {
+    uint32_t start = sensorTimerStart();
+    hostAdvanceMicros(micros);
+    sensorTimerStop(reader, start, error);
+}
+
+// bucket i holds [2^i, 2^(i+1)) microseconds, 0 goes with 1 and the last bucket takes the rest
+static void testHistogramBuckets() {
+    static const struct {
+        unsigned long micros;
+        int bucket;
+    } reads[] = {
+        { 0, 0 }, { 1, 0 }, { 2, 1 }, { 3, 1 }, { 4, 2 }, { 7, 2 }, { 8, 3 },
+        { 1023, 9 }, { 1024, 10 }, { 16383, 13 }, { 16384, 14 }, { 32767, 14 },
+        { 32768, 15 }, { 4000000000UL, 15 },
+    };
+    const int count = sizeof(reads) / sizeof(reads[0]);
+
+    for (int i = 0; i < count; i++) {
+        clearSensorTiming();
+        timedRead(SENSOR_READ_PRESSURE, reads[i].micros, false);
+
+        SENSOR_TIMING timing;
+        CHECK(getSensorTiming(SENSOR_READ_PRESSURE, &timing));
+        CHECK_EQUAL_INT(1, timing.count);
+        CHECK_EQUAL_INT(reads[i].micros, timing.maxMicros);
+        for (int bucket = 0; bucket < SENSOR_HISTOGRAM_BUCKETS; bucket++) {
+            CHECK_EQUAL_INT(bucket == reads[i].bucket ? 1 : 0, timing.histogram[bucket]);
+        }
+    }
+}
+
+// failed reads count as errors and stay out of the latency figures
+static void testErrorsKeptOut() {
+    clearSensorTiming();
+    timedRead(SENSOR_READ_HUMIDITY, 100, false);
+    timedRead(SENSOR_READ_HUMIDITY, 50000, true);
+
+    SENSOR_TIMING timing;
+    getSensorTiming(SENSOR_READ_HUMIDITY, &timing);
+    CHECK_EQUAL_INT(1, timing.count);
+    CHECK_EQUAL_INT(1, timing.errors);
+    CHECK_EQUAL_INT(100, timing.maxMicros);
+    CHECK_EQUAL_INT(100, timing.totalMicros);
+}
+
+// the length the JSON would have if every number had the 10 digits of a 32 bit counter
+static int worstCaseLength(const char *json) {
+    int length = 0;
+    int digits = 0;
+    for (const char *c = json; ; c++) {
+        if (*c >= '0' && *c <= '9') {
+            digits++;
+            continue;
+        }
+        if (digits > 0) {
+            length += 10;
+            digits = 0;
+        }
+        if (*c == 0) {
+            break;
+        }
+        length++;
+    }
+    return length;
+}
+
+// getSensorStats answers with this JSON, with every reader and the FIFO capture reported
+// it still fits the method response when every counter is at its widest, by then without
+// the histograms
+static void testJsonFitsMethodResponse() {
+    AcceptingDevice lsm6dsl;
+    hostI2cAttach(LSM6DSL_ACC_GYRO_I2C_ADDRESS_HIGH, &lsm6dsl);
+    CHECK(enableMotionFifo(416));
+
+    clearSensorTiming();
+    for (int reader = 0; reader < SENSOR_READ_COUNT; reader++) {
+        for (int bucket = 0; bucket < SENSOR_HISTOGRAM_BUCKETS; bucket++) {
+            timedRead(reader, 1UL << bucket, false);
+        }
+        timedRead(reader, 4000000000UL, false);
+        timedRead(reader, 10, true);
+    }
+
+    char json[METHOD_RESPONSE_MAX];
+    int length = buildSensorStatsJson(json, sizeof(json));
+    CHECK(length > 0);
+    CHECK(strstr(json, "\"motionFifo\":{\"count\":17,\"errors\":1,") != NULL);
+    CHECK(strstr(json, "\"maxUs\":4000000000,\"histogram\":[1,1,1,") != NULL);
+    CHECK(strstr(json, "\"motionCapture\":{") != NULL);
+    int fullWorstCase = worstCaseLength(json);
+
+    // the same counters in a response too small for the histograms
+    int shortLength = buildSensorStatsJson(json, length);
+    CHECK(shortLength > 0 && shortLength < length);
+    CHECK(strstr(json, "histogram") == NULL);
+    CHECK(strstr(json, "\"motionFifo\":{\"count\":17,\"errors\":1,\"avgUs\":") != NULL);
+    CHECK(strstr(json, "\"motionCapture\":{") != NULL);
+
+    int worstCase = worstCaseLength(json);
+    CHECK(worstCase < METHOD_RESPONSE_MAX);
+    printf("sensor stats: %d bytes, %d with every number at 10 digits, without histograms %d, the method response holds %d\n",
+        length, fullWorstCase, worstCase, METHOD_RESPONSE_MAX - 1);
+
+    disableMotionFifo();
+    hostI2cAttach(LSM6DSL_ACC_GYRO_I2C_ADDRESS_HIGH, NULL);
+}
+
+int main() {
+    initSensors();
+    testHistogramBuckets();
+    testErrorsKeptOut();
+    testJsonFitsMethodResponse();
+    return testResult("sensorStatsTest");
+}
@@ -0,0 +1,410 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "DevI2C.h"
+#include "LSM6DSLSensor.h"
+#include "HTS221Sensor.h"
+
+#include "../inc/sensors.h"
+#include "../inc/sensorStats.h"
+
+#include "testing.h"
+
+// the LSM6DSL FIFO registers as the datasheet lays them out, the FIFO holds 16 bit words
+// in the order gyroscope x, y, z then accelerometer x, y, z, reading FIFO_DATA_OUT_L
+// repeatedly pops the next word low byte first
+#define REG_FIFO_CTRL1 0x06
+#define REG_FIFO_CTRL2 0x07
+#define REG_FIFO_CTRL3 0x08
+#define REG_FIFO_CTRL5 0x0A
+#define REG_FIFO_STATUS1 0x3A
+#define REG_FIFO_DATA_OUT_L 0x3E
+
+// a little under the chip's 2048 words so the count always fits the 11 bits of DIFF_FIFO
+#define FIFO_WORDS 2044
+#define PATTERN_WORDS 6
+
+class SimulatedLsm6dsl : public HostI2cDevice {
+public:
+    uint8_t regs[128];
+    int16_t fifo[FIFO_WORDS];
+    int head;
+    int count;
+    int pattern;
+    bool overrun;
+
+    // byte lengths of the FIFO_DATA_OUT reads
+    int dataReads[64];
+    int dataReadCount;
+
+    void reset() {
+        memset(regs, 0, sizeof(regs));
+        head = 0;
+        count = 0;
+        pattern = 0;
+        overrun = false;
+        dataReadCount = 0;
+    }
+
+    int watermark() {
+        return regs[REG_FIFO_CTRL1] | ((regs[REG_FIFO_CTRL2] & 0x07) << 8);
+    }
+
+    // in continuous mode a full FIFO drops its oldest word for every new one
+    void pushWord(int16_t value) {
+        if ((regs[REG_FIFO_CTRL5] & 0x07) == 0) {
+            return;
+        }
+        if (count == FIFO_WORDS) {
+            popWord();
+            overrun = true;
+        }
+        fifo[(head + count++) % FIFO_WORDS] = value;
+    }
+
+    // the pattern position follows the words read, dropped words included
+    int16_t popWord() {
+        int16_t value = fifo[head];
+        head = (head + 1) % FIFO_WORDS;
+        count--;
+        pattern = (pattern + 1) % PATTERN_WORDS;
+        return value;
+    }
+
+    void produce(const int16_t *gyro, const int16_t *accel) {
+        for (int i = 0; i < 3; i++) {
+            pushWord(gyro[i]);
+        }
+        for (int i = 0; i < 3; i++) {
+            pushWord(accel[i]);
+        }
+    }
+
+    int read(uint8_t reg, uint8_t *data, uint16_t length) {
+        if (reg == REG_FIFO_DATA_OUT_L) {
+            if (dataReadCount < 64) {
+                dataReads[dataReadCount++] = length;
+            }
+            for (int i = 0; i + 1 < length; i += 2) {
+                int16_t value = (count > 0) ? popWord() : 0;
+                data[i] = value & 0xFF;
+                data[i + 1] = (value >> 8) & 0xFF;
+            }
+            return 0;
+        }
+
+        uint8_t status[4];
+        status[0] = count & 0xFF;
+        status[1] = ((count >> 8) & 0x07) | (count == 0 ? 0x10 : 0) | (overrun ? 0x40 : 0) |
+            (watermark() > 0 && count >= watermark() ? 0x80 : 0);
+        status[2] = pattern & 0xFF;
+        status[3] = (pattern >> 8) & 0x03;
+        for (int i = 0; i < length; i++) {
+            int at = reg + i;
+            data[i] = (at >= REG_FIFO_STATUS1 && at < REG_FIFO_STATUS1 + 4) ? status[at - REG_FIFO_STATUS1] : regs[at & 0x7F];
+        }
+        if (reg == REG_FIFO_STATUS1) {
+            overrun = false;
+        }
+        return 0;
+    }
+
+    // bypass mode empties the FIFO
+    int write(uint8_t reg, const uint8_t *data, uint16_t /* length */) {
+        regs[reg & 0x7F] = data[0];
+        if (reg == REG_FIFO_CTRL5 && (data[0] & 0x07) == 0) {
+            head = 0;
+            count = 0;
+            pattern = 0;
+        }
+        return 0;
+    }
+};
+
+static SimulatedLsm6dsl chip;
+
+static int16_t gyroWord(int sample, int axis) {
+    return (int16_t)(sample * 10 + axis - 300);
+}
+
+static int16_t accelWord(int sample, int axis) {
+    return (int16_t)(-sample * 100 - axis);
+}
+
+static void produceSamples(int first, int samples) {
+    for (int i = first; i < first + samples; i++) {
+        int16_t gyro[3];
+        int16_t accel[3];
+        for (int axis = 0; axis < 3; axis++) {
+            gyro[axis] = gyroWord(i, axis);
+            accel[axis] = accelWord(i, axis);
+        }
+        chip.produce(gyro, accel);
+    }
+}
+
+// the sensitivities the stand-in driver reports, applied the way sensors.cpp applies them
+static bool sampleIs(const MOTION_SAMPLE *sample, int index) {
+    for (int axis = 0; axis < 3; axis++) {
+        if (sample->gyro[axis] != (int)(gyroWord(index, axis) * 70.0f) ||
+            sample->accel[axis] != (int)(accelWord(index, axis) * 0.061f)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void start() {
+    chip.reset();
+    hostI2cAttach(LSM6DSL_ACC_GYRO_I2C_ADDRESS_HIGH, &chip);
+    hostSetMillis(1000);
+    clearSensorTiming();
+    MOTION_SAMPLE sample;
+    while (takeMotionSample(&sample)) {
+    }
+    CHECK(enableMotionFifo(416));
+    chip.dataReadCount = 0;
+}
+
+// enabling programs continuous mode at the rate, no decimation and a watermark of one read
+static void testFifoConfigured() {
+    start();
+    CHECK(isMotionFifoEnabled());
+    CHECK_EQUAL_INT(96, chip.watermark());
+    CHECK_EQUAL_INT(0x09, chip.regs[REG_FIFO_CTRL3]);
+    CHECK_EQUAL_INT((6 << 3) | 0x06, chip.regs[REG_FIFO_CTRL5]);
+
+    disableMotionFifo();
+    CHECK(!isMotionFifoEnabled());
+    CHECK_EQUAL_INT(0, chip.regs[REG_FIFO_CTRL5] & 0x07);
+    CHECK_EQUAL_INT(0, drainMotionFifo());
+}
+
+// samples come out gyroscope then accelerometer, low byte first, in the order they were taken
+static void testWordOrder() {
+    start();
+    produceSamples(0, 3);
+    CHECK_EQUAL_INT(3, drainMotionFifo());
+
+    MOTION_SAMPLE sample;
+    for (int i = 0; i < 3; i++) {
+        CHECK(takeMotionSample(&sample));
+        CHECK(sampleIs(&sample, i));
+    }
+    CHECK(!takeMotionSample(&sample));
+    CHECK_EQUAL_INT(0, chip.count);
+}
+
+// past the watermark the FIFO is read in bulk reads of one watermark each
+static void testWatermarkBulkReads() {
+    start();
+    produceSamples(0, 40);
+    uint8_t status[2];
+    chip.read(REG_FIFO_STATUS1, status, 2);
+    CHECK((status[1] & 0x80) != 0);
+
+    CHECK_EQUAL_INT(40, drainMotionFifo());
+    CHECK_EQUAL_INT(3, chip.dataReadCount);
+    CHECK_EQUAL_INT(16 * 12, chip.dataReads[0]);
+    CHECK_EQUAL_INT(16 * 12, chip.dataReads[1]);
+    CHECK_EQUAL_INT(8 * 12, chip.dataReads[2]);
+
+    MOTION_SAMPLE sample;
+    int taken = 0;
+    while (takeMotionSample(&sample)) {
+        CHECK(sampleIs(&sample, taken));
+        taken++;
+    }
+    CHECK_EQUAL_INT(40, taken);
+
+    // one status read of 4 bytes and three data reads, each with its register address byte
+    hostAdvanceMillis(1000);
+    CHECK(fabsf(getMotionSamplesPerSecond() - 40.0f) < 0.01f);
+    float bytes = (4 + 1) + (16 * 12 + 1) * 2 + (8 * 12 + 1);
+    CHECK(fabsf(getMotionI2cBytesPerSample() - bytes / 40) < 0.01f);
+}
+
+// a sample still being written stays in the FIFO, a read that starts part way into a
+// sample skips to the next gyroscope x
+static void testPartialReads() {
+    start();
+    produceSamples(0, 2);
+    chip.pushWord(gyroWord(2, 0));
+    chip.pushWord(gyroWord(2, 1));
+
+    CHECK_EQUAL_INT(2, drainMotionFifo());
+    CHECK_EQUAL_INT(2, chip.count);
+    CHECK_EQUAL_INT(0, chip.pattern);
+
+    // the rest of sample 2 arrives, then sample 3
+    chip.pushWord(gyroWord(2, 2));
+    for (int axis = 0; axis < 3; axis++) {
+        chip.pushWord(accelWord(2, axis));
+    }
+    produceSamples(3, 1);
+    CHECK_EQUAL_INT(2, drainMotionFifo());
+
+    MOTION_SAMPLE sample;
+    for (int i = 0; i < 4; i++) {
+        CHECK(takeMotionSample(&sample));
+        CHECK(sampleIs(&sample, i));
+    }
+
+    // something else read two words, the next drain realigns and loses only that sample
+    produceSamples(4, 3);
+    chip.popWord();
+    chip.popWord();
+    CHECK_EQUAL_INT(2, chip.pattern);
+    CHECK_EQUAL_INT(2, drainMotionFifo());
+    CHECK(takeMotionSample(&sample));
+    CHECK(sampleIs(&sample, 5));
+    CHECK(takeMotionSample(&sample));
+    CHECK(sampleIs(&sample, 6));
+    CHECK(!takeMotionSample(&sample));
+}
+
+// an overrun loses the oldest words, the drain still returns whole samples
+static void testOverrun() {
+    start();
+    produceSamples(0, FIFO_WORDS / PATTERN_WORDS + 1);
+    CHECK(chip.overrun);
+    CHECK(chip.pattern != 0);
+
+    // the sample the overrun cut into is skipped
+    int drained = drainMotionFifo();
+    CHECK_EQUAL_INT(FIFO_WORDS / PATTERN_WORDS, drained);
+    CHECK(!chip.overrun);
+
+    SENSOR_TIMING timing;
+    getSensorTiming(SENSOR_READ_MOTION_FIFO, &timing);
+    CHECK_EQUAL_INT(1, timing.count);
+    CHECK_EQUAL_INT(0, timing.errors);
+}
+
+// the throughput and bus cost are part of the getSensorStats response while capturing
+static void testCountersReported() {
+    char buffer[1024];
+    start();
+    produceSamples(0, 16);
+    drainMotionFifo();
+    hostAdvanceMillis(500);
+
+    CHECK(buildSensorStatsJson(buffer, sizeof(buffer)) > 0);
+    CHECK(strstr(buffer, "\"motionCapture\":{\"samplesPerSec\":32.0") != NULL);
+    CHECK(strstr(buffer, "\"i2cBytesPerSample\":12.38}}") != NULL);
+
+    disableMotionFifo();
+    CHECK(buildSensorStatsJson(buffer, sizeof(buffer)) > 0);
+    CHECK(strstr(buffer, "motionCapture") == NULL);
+}
+
+// the HTS221 with its factory calibration, 30 and 70 %rH at output 0 and 8000, 20 and 30 C
+// at 0 and 1000, the outputs read 50 %rH and 25 C
+class SimulatedHts221 : public HostI2cDevice {
+public:
+    uint8_t regs[128];
+
+    SimulatedHts221() {
+        memset(regs, 0, sizeof(regs));
+        regs[0x30] = 60;
+        regs[0x31] = 140;
+        setWord(0x36, 0);
+        setWord(0x3A, 8000);
+        regs[0x32] = 160;
+        regs[0x33] = 240;
+        setWord(0x3C, 0);
+        setWord(0x3E, 1000);
+        setWord(0x28, 4000);
+        setWord(0x2A, 500);
+    }
+
+    void setWord(int reg, int16_t value) {
+        regs[reg] = value & 0xFF;
+        regs[reg + 1] = (value >> 8) & 0xFF;
+    }
+
+    // the top bit of the register address asks for auto increment
+    int read(uint8_t reg, uint8_t *data, uint16_t length) {
+        for (int i = 0; i < length; i++) {
+            data[i] = regs[((reg & 0x7F) + i) & 0x7F];
+        }
+        return 0;
+    }
+
+    int write(uint8_t reg, const uint8_t *data, uint16_t /* length */) {
+        regs[reg & 0x7F] = data[0];
+        return 0;
+    }
+};
+
+static SimulatedHts221 hts221;
+
+extern HTS221Sensor *tempHumidity;
+
+// what readHumidity and readTemperature did before, a reset ahead of each read
+static void readWithResets(float *humidity, float *temperature) {
+    tempHumidity->reset();
+    tempHumidity->getHumidity(humidity);
+    tempHumidity->reset();
+    tempHumidity->getTemperature(temperature);
+}
+
+// HTS221 bus transactions of a sampling cycle, 100 ms samples over a 5 s window
+static void benchmarkHts221Transactions() {
+    const int cycles = 50;
+    float humidity = 0;
+    float temperature = 0;
+    hostI2cAttach(HTS221_I2C_ADDRESS, &hts221);
+    hostSetMillis(100000);
+
+    hostI2cClearTransactions();
+    for (int i = 0; i < cycles; i++) {
+        readWithResets(&humidity, &temperature);
+        hostAdvanceMillis(100);
+    }
+    unsigned long before = hostI2cTransactions(HTS221_I2C_ADDRESS);
+    CHECK(fabsf(humidity - 50.0f) < 0.01f);
+    CHECK(fabsf(temperature - 25.0f) < 0.01f);
+
+    hostI2cClearTransactions();
+    for (int i = 0; i < cycles; i++) {
+        humidity = readHumidity();
+        temperature = readTemperature();
+        hostAdvanceMillis(100);
+    }
+    unsigned long after = hostI2cTransactions(HTS221_I2C_ADDRESS);
+    CHECK(fabsf(humidity - 50.0f) < 0.01f);
+    CHECK(fabsf(temperature - 25.0f) < 0.01f);
+
+    // one combined read per one second conversion instead of two resets and two reads a cycle
+    CHECK_EQUAL_INT(cycles * 12, before);
+    CHECK_EQUAL_INT(cycles / 10 * 8, after);
+    printf("HTS221 I2C transactions per cycle: %.1f with resets, %.1f cached\n",
+        (float)before / cycles, (float)after / cycles);
+}
+
+// a failed read is not cached, the next read goes to the chip again
+static void testHts221ErrorNotCached() {
+    hostI2cAttach(HTS221_I2C_ADDRESS, NULL);
+    hostAdvanceMillis(1000);
+    CHECK(readHumidity() == 0xFFFF);
+
+    hostI2cAttach(HTS221_I2C_ADDRESS, &hts221);
+    hostI2cClearTransactions();
+    CHECK(fabsf(readTemperature() - 25.0f) < 0.01f);
+    CHECK_EQUAL_INT(8, hostI2cTransactions(HTS221_I2C_ADDRESS));
+}
+
+int main() {
+    initSensors();
+    testFifoConfigured();
+    testWordOrder();
+    testWatermarkBulkReads();
+    testPartialReads();
+    testOverrun();
+    testCountersReported();
+    benchmarkHts221Transactions();
+    testHts221ErrorNotCached();
+    return testResult("sensorsTest");
+}
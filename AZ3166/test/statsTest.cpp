@@ -0,0 +1,55 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/stats.h"
+
+#include "testing.h"
+
+static void testCountersInJson() {
+    char buffer[256];
+    clearCounters();
+
+    int length = buildCounterStatsJson(buffer, sizeof(buffer));
+    CHECK_EQUAL_TEXT("{\"sent\":0,\"failed\":0,\"desired\":0,\"reported\":0,\"dropped\":0,\"backpressure\":0,"
+        "\"bytesSavedPerSample\":0,\"suppressedPercent\":0,\"maxLoopMs\":0}", buffer);
+    CHECK_EQUAL_INT((int)strlen(buffer), length);
+
+    for (int i = 0; i < 3; i++) {
+        incrementTelemetryCount();
+    }
+    incrementDroppedCount();
+    incrementBackpressureCount();
+    incrementBackpressureCount();
+    addBatchSavings(10, 250);
+    addChannelReports(3, 1);
+    recordLoopTime(12);
+    recordLoopTime(7);
+
+    buildCounterStatsJson(buffer, sizeof(buffer));
+    CHECK(strstr(buffer, "\"sent\":3,") != NULL);
+    CHECK(strstr(buffer, "\"dropped\":1,\"backpressure\":2,") != NULL);
+    CHECK(strstr(buffer, "\"bytesSavedPerSample\":25,\"suppressedPercent\":25,\"maxLoopMs\":12}") != NULL);
+}
+
+// the largest counters still fit the 1024 byte method response, a small buffer is an error
+static void testLargestCountersFit() {
+    char buffer[1024];
+    clearCounters();
+    for (int i = 0; i < 99999999; i += 4096) {
+        incrementTelemetryCount();
+    }
+    recordLoopTime(4000000000UL);
+
+    int length = buildCounterStatsJson(buffer, sizeof(buffer));
+    printf("device stats: %d bytes\n", length);
+    CHECK(length > 0 && length < (int)sizeof(buffer));
+    CHECK_EQUAL_INT(-1, buildCounterStatsJson(buffer, 32));
+}
+
+int main() {
+    testCountersInJson();
+    testLargestCountersFit();
+    return testResult("statsTest");
+}
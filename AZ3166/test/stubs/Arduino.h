@@ -0,0 +1,111 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+// host stand-in for the parts of the AZ3166 Arduino core the tested modules use
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <math.h>
+#include <time.h>
+#include <ctype.h>
+
+#include <string>
+
+#include "OledDisplay.h"
+
+#define LED_WIFI 1
+#define LED_AZURE 2
+#define LED_USER 3
+
+#define F(text) (text)
+
+// the clock only moves when a test moves it, delay moves it too, millis and micros
+// read the same clock
+unsigned long millis();
+unsigned long micros();
+void delay(int ms);
+void hostSetMillis(unsigned long now);
+void hostAdvanceMillis(unsigned long ms);
+void hostAdvanceMicros(unsigned long us);
+
+void digitalWrite(int pin, int value);
+int hostPinState(int pin);
+
+long random(long low, long high);
+void randomSeed(unsigned long seed);
+
+// serial output is dropped unless IOTC_TEST_VERBOSE is set
+class HostSerial {
+public:
+    int printf(const char *format, ...);
+    void print(const char *text);
+    void println(const char *text = "");
+};
+
+extern HostSerial Serial;
+
+char *dtostrf(double number, signed char width, unsigned char prec, char *s);
+
+// enough of the Arduino String for the reference code in the tests
+class String {
+public:
+    String() {}
+    String(const char *text) : text(text != NULL ? text : "") {}
+    String(const std::string &text) : text(text) {}
+    String(char c) : text(1, c) {}
+    String(int value) : text(std::to_string(value)) {}
+    String(long value) : text(std::to_string(value)) {}
+    String(unsigned long value) : text(std::to_string(value)) {}
+    String(float value, unsigned char decimalPlaces = 2) {
+        char buf[33];
+        text = dtostrf(value, decimalPlaces + 2, decimalPlaces, buf);
+    }
+
+    const char *c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    char charAt(unsigned int index) const { return index < text.size() ? text[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    bool concat(const String &other) { text += other.text; return true; }
+    bool concat(const char *other) { text += other; return true; }
+    bool concat(char c) { text += c; return true; }
+    String &operator+=(const String &other) { concat(other); return *this; }
+    String &operator+=(const char *other) { concat(other); return *this; }
+    String &operator+=(char c) { concat(c); return *this; }
+
+    void replace(const String &find, const String &replacement) {
+        if (find.text.empty()) {
+            return;
+        }
+        size_t at = 0;
+        while ((at = text.find(find.text, at)) != std::string::npos) {
+            text.replace(at, find.text.size(), replacement.text);
+            at += replacement.text.size();
+        }
+    }
+
+    int indexOf(const char *find) const {
+        size_t at = text.find(find);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+    String substring(unsigned int from, unsigned int to = (unsigned int)-1) const {
+        if (from > text.size()) {
+            return String();
+        }
+        return String(text.substr(from, to == (unsigned int)-1 ? std::string::npos : to - from));
+    }
+
+    bool operator==(const String &other) const { return text == other.text; }
+    bool operator==(const char *other) const { return text == other; }
+
+private:
+    std::string text;
+};
+
+#endif /* HOST_ARDUINO_H */
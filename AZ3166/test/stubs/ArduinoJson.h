@@ -0,0 +1,12 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+// the library is not available on the host, the tested modules only pass the
+// parsed object through to the handlers
+#ifndef HOST_ARDUINO_JSON_H
+#define HOST_ARDUINO_JSON_H
+
+class JsonObject {
+};
+
+#endif /* HOST_ARDUINO_JSON_H */
@@ -0,0 +1,36 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_DEV_I2C_H
+#define HOST_DEV_I2C_H
+
+#include <stdint.h>
+
+typedef enum {
+    D4,
+    D5,
+    D14,
+    D15
+} PinName;
+
+// a simulated chip on the host I2C bus, tests attach one per address
+class HostI2cDevice {
+public:
+    virtual ~HostI2cDevice() {}
+    virtual int read(uint8_t reg, uint8_t *data, uint16_t length) = 0;
+    virtual int write(uint8_t reg, const uint8_t *data, uint16_t length) = 0;
+};
+
+// transactions to an address without a device fail, every transaction is counted
+void hostI2cAttach(uint8_t address, HostI2cDevice *device);
+unsigned long hostI2cTransactions(uint8_t address);
+void hostI2cClearTransactions();
+
+class DevI2C {
+public:
+    DevI2C(PinName /* sda */, PinName /* scl */) {}
+    int i2c_read(uint8_t *buffer, uint8_t address, uint8_t reg, uint16_t length);
+    int i2c_write(uint8_t *buffer, uint8_t address, uint8_t reg, uint16_t length);
+};
+
+#endif /* HOST_DEV_I2C_H */
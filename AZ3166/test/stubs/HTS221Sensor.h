@@ -0,0 +1,28 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_HTS221_SENSOR_H
+#define HOST_HTS221_SENSOR_H
+
+#include "DevI2C.h"
+
+#define HTS221_I2C_ADDRESS 0xBE
+
+// makes the same register reads and writes over the host bus as the DevKit driver, so
+// tests can count the transactions a read path costs
+class HTS221Sensor {
+public:
+    HTS221Sensor(DevI2C &i2c) : devI2c(i2c) {}
+    int init(void *init);
+    int enable();
+    int reset();
+    int getHumidity(float *humidity);
+    int getTemperature(float *temperature);
+
+private:
+    int readReg(uint8_t reg, uint8_t *data, uint16_t length);
+    int writeReg(uint8_t reg, uint8_t value);
+    DevI2C &devI2c;
+};
+
+#endif /* HOST_HTS221_SENSOR_H */
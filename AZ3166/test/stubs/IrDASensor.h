@@ -0,0 +1,13 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_IRDA_SENSOR_H
+#define HOST_IRDA_SENSOR_H
+
+class IRDASensor {
+public:
+    int init() { return 0; }
+    int IRDATransmit(unsigned char * /* data */, int /* size */, int /* timeout */) { return 0; }
+};
+
+#endif /* HOST_IRDA_SENSOR_H */
@@ -0,0 +1,16 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_LPS22HB_SENSOR_H
+#define HOST_LPS22HB_SENSOR_H
+
+#include "DevI2C.h"
+
+class LPS22HBSensor {
+public:
+    LPS22HBSensor(DevI2C & /* i2c */) {}
+    int init(void * /* init */) { return 0; }
+    int getPressure(float *pressure) { *pressure = 1013.25f; return 0; }
+};
+
+#endif /* HOST_LPS22HB_SENSOR_H */
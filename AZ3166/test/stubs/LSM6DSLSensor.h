@@ -0,0 +1,32 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_LSM6DSL_SENSOR_H
+#define HOST_LSM6DSL_SENSOR_H
+
+#include "DevI2C.h"
+
+#define LSM6DSL_ACC_GYRO_I2C_ADDRESS_HIGH 0xD6
+#define LSM6DSL_PEDOMETER_THRESHOLD_MID_LOW 0x07
+
+// the driver calls the sketch makes outside the FIFO path, which goes to the bus directly,
+// sensitivities are the driver's for +-2 g and 2000 dps
+class LSM6DSLSensor {
+public:
+    LSM6DSLSensor(DevI2C & /* i2c */, PinName /* int1 */, PinName /* int2 */) {}
+    int init(void * /* init */) { return 0; }
+    int enableAccelerator() { return 0; }
+    int enableGyroscope() { return 0; }
+    int enablePedometer() { return 0; }
+    int setPedometerThreshold(uint8_t /* threshold */) { return 0; }
+    int getStepCounter(int *steps) { *steps = 0; return 0; }
+    int resetStepCounter() { return 0; }
+    int setXOdr(float /* odr */) { return 0; }
+    int setGOdr(float /* odr */) { return 0; }
+    int getXSensitivity(float *sensitivity) { *sensitivity = 0.061f; return 0; }
+    int getGSensitivity(float *sensitivity) { *sensitivity = 70.0f; return 0; }
+    int getXAxes(int *axes) { axes[0] = 0; axes[1] = 0; axes[2] = 1000; return 0; }
+    int getGAxes(int *axes) { axes[0] = 0; axes[1] = 0; axes[2] = 0; return 0; }
+};
+
+#endif /* HOST_LSM6DSL_SENSOR_H */
@@ -0,0 +1,21 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_NTP_CLIENT_H
+#define HOST_NTP_CLIENT_H
+
+class NetworkInterface;
+
+typedef enum {
+    NTP_OK = 0,
+    NTP_TIMEOUT
+} NTPResult;
+
+// time is never synced on the host
+class NTPClient {
+public:
+    NTPClient(NetworkInterface * /* network */) {}
+    NTPResult setTime(char * /* host */) { return NTP_TIMEOUT; }
+};
+
+#endif /* HOST_NTP_CLIENT_H */
@@ -0,0 +1,27 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_OLED_DISPLAY_H
+#define HOST_OLED_DISPLAY_H
+
+// records what would have gone to the SSD1306 so tests can check it, bytes counts what the
+// driver would send over I2C
+class OLEDDisplay {
+public:
+    void clean();
+    int print(unsigned int line, const char *text, bool wrap = false);
+    void draw(int x0, int y0, int x1, int y1, unsigned char *bitmap);
+
+    // what was drawn since the last reset
+    unsigned long cleans;
+    unsigned long prints;
+    unsigned long draws;
+    unsigned long bytes;
+    const unsigned char *lastBitmap;
+    char lastText[4][64];
+    void reset();
+};
+
+extern OLEDDisplay Screen;
+
+#endif /* HOST_OLED_DISPLAY_H */
@@ -0,0 +1,15 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_RGB_LED_H
+#define HOST_RGB_LED_H
+
+#include <stdint.h>
+
+class RGB_LED {
+public:
+    void setColor(uint8_t /* red */, uint8_t /* green */, uint8_t /* blue */) {}
+    void turnOff() {}
+};
+
+#endif /* HOST_RGB_LED_H */
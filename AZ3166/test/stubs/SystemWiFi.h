@@ -0,0 +1,14 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef HOST_SYSTEM_WIFI_H
+#define HOST_SYSTEM_WIFI_H
+
+class NetworkInterface;
+
+// NULL while the host "network" is down, see hostSetConnected
+const char *SystemWiFiSSID();
+NetworkInterface *WiFiInterface();
+void hostSetConnected(bool connected);
+
+#endif /* HOST_SYSTEM_WIFI_H */
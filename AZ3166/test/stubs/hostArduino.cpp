@@ -0,0 +1,139 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+#include "mbed.h"
+#include "SystemWiFi.h"
+
+static unsigned long long hostMicros = 0;
+static int pins[8];
+static bool hostConnected = true;
+static osThreadId hostThreadId = (osThreadId)1;
+
+HostSerial Serial;
+OLEDDisplay Screen;
+
+unsigned long millis() {
+    return (unsigned long)(hostMicros / 1000);
+}
+
+unsigned long micros() {
+    return (unsigned long)hostMicros;
+}
+
+void delay(int ms) {
+    hostMicros += ms * 1000ULL;
+}
+
+void hostSetMillis(unsigned long now) {
+    hostMicros = now * 1000ULL;
+}
+
+void hostAdvanceMillis(unsigned long ms) {
+    hostMicros += ms * 1000ULL;
+}
+
+void hostAdvanceMicros(unsigned long us) {
+    hostMicros += us;
+}
+
+void digitalWrite(int pin, int value) {
+    if (pin >= 0 && pin < 8) {
+        pins[pin] = value;
+    }
+}
+
+int hostPinState(int pin) {
+    return (pin >= 0 && pin < 8) ? pins[pin] : 0;
+}
+
+long random(long low, long high) {
+    return low + rand() % (high - low);
+}
+
+void randomSeed(unsigned long seed) {
+    srand(seed);
+}
+
+static bool verbose() {
+    static int enabled = -1;
+    if (enabled < 0) {
+        enabled = getenv("IOTC_TEST_VERBOSE") != NULL;
+    }
+    return enabled != 0;
+}
+
+int HostSerial::printf(const char *format, ...) {
+    if (!verbose()) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, format);
+    int length = vprintf(format, args);
+    va_end(args);
+    return length;
+}
+
+void HostSerial::print(const char *text) {
+    if (verbose()) {
+        fputs(text, stdout);
+    }
+}
+
+void HostSerial::println(const char *text) {
+    if (verbose()) {
+        puts(text);
+    }
+}
+
+void OLEDDisplay::clean() {
+    cleans++;
+    bytes += 1024;
+    memset(lastText, 0, sizeof(lastText));
+}
+
+int OLEDDisplay::print(unsigned int line, const char *text, bool wrap) {
+    prints++;
+    // the driver draws every character as 8 columns of two pages, wrapped text goes on to the last line
+    size_t room = (wrap && line < 4) ? (4 - line) * 16 : 16;
+    bytes += (strlen(text) < room ? strlen(text) : room) * 16;
+    if (line < 4) {
+        snprintf(lastText[line], sizeof(lastText[line]), "%s", text);
+    }
+    return 0;
+}
+
+void OLEDDisplay::draw(int x0, int y0, int x1, int y1, unsigned char *bitmap) {
+    draws++;
+    bytes += (x1 - x0) * (y1 - y0);
+    lastBitmap = bitmap;
+}
+
+void OLEDDisplay::reset() {
+    cleans = 0;
+    prints = 0;
+    draws = 0;
+    bytes = 0;
+    lastBitmap = NULL;
+    memset(lastText, 0, sizeof(lastText));
+}
+
+const char *SystemWiFiSSID() {
+    return hostConnected ? "host" : NULL;
+}
+
+NetworkInterface *WiFiInterface() {
+    return NULL;
+}
+
+void hostSetConnected(bool connected) {
+    hostConnected = connected;
+}
+
+osThreadId osThreadGetId() {
+    return hostThreadId;
+}
+
+void hostSetThreadId(osThreadId id) {
+    hostThreadId = id;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include <malloc.h>
+
+#include "hostHeap.h"
+
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+}
+
+// the tests are single threaded, usable sizes stand in for the requested ones
+static long long inUse = 0;
+static long long peak = 0;
+static unsigned long allocations = 0;
+
+static void *track(void *pointer) {
+    if (pointer != NULL) {
+        allocations++;
+        inUse += malloc_usable_size(pointer);
+        if (inUse > peak) {
+            peak = inUse;
+        }
+    }
+    return pointer;
+}
+
+extern "C" void *malloc(size_t size) {
+    return track(__libc_malloc(size));
+}
+
+extern "C" void *calloc(size_t count, size_t size) {
+    return track(__libc_calloc(count, size));
+}
+
+extern "C" void *realloc(void *pointer, size_t size) {
+    if (pointer != NULL) {
+        inUse -= malloc_usable_size(pointer);
+    }
+    return track(__libc_realloc(pointer, size));
+}
+
+extern "C" void free(void *pointer) {
+    if (pointer != NULL) {
+        inUse -= malloc_usable_size(pointer);
+    }
+    __libc_free(pointer);
+}
+
+long long hostHeapInUse() {
+    return inUse;
+}
+
+long long hostHeapPeak() {
+    return peak;
+}
+
+unsigned long hostHeapAllocations() {
+    return allocations;
+}
+
+void hostHeapResetPeak() {
+    peak = inUse;
+}
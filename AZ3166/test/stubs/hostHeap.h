@@ -0,0 +1,17 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+// malloc, calloc, realloc and free are counted on the host so tests can show heap use
+#ifndef HOST_HEAP_H
+#define HOST_HEAP_H
+
+#include <stddef.h>
+
+long long hostHeapInUse();
+long long hostHeapPeak();
+unsigned long hostHeapAllocations();
+
+// starts the peak over from what is in use now
+void hostHeapResetPeak();
+
+#endif /* HOST_HEAP_H */
@@ -0,0 +1,144 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include <stddef.h>
+
+#include "DevI2C.h"
+#include "HTS221Sensor.h"
+
+// 8 bit addresses as the DevKit drivers use them, the read/write bit is ignored
+static HostI2cDevice *devices[128];
+static unsigned long transactions[128];
+
+void hostI2cAttach(uint8_t address, HostI2cDevice *device) {
+    devices[address >> 1] = device;
+}
+
+unsigned long hostI2cTransactions(uint8_t address) {
+    return transactions[address >> 1];
+}
+
+void hostI2cClearTransactions() {
+    for (int i = 0; i < 128; i++) {
+        transactions[i] = 0;
+    }
+}
+
+int DevI2C::i2c_read(uint8_t *buffer, uint8_t address, uint8_t reg, uint16_t length) {
+    transactions[address >> 1]++;
+    HostI2cDevice *device = devices[address >> 1];
+    return device != NULL ? device->read(reg, buffer, length) : 1;
+}
+
+int DevI2C::i2c_write(uint8_t *buffer, uint8_t address, uint8_t reg, uint16_t length) {
+    transactions[address >> 1]++;
+    HostI2cDevice *device = devices[address >> 1];
+    return device != NULL ? device->write(reg, buffer, length) : 1;
+}
+
+// HTS221 registers, multi byte reads set the auto increment bit like the ST driver
+#define HTS221_CTRL_REG1 0x20
+#define HTS221_CTRL_REG2 0x21
+#define HTS221_HR_OUT_L 0x28
+#define HTS221_TEMP_OUT_L 0x2A
+#define HTS221_H0_RH_X2 0x30
+#define HTS221_T0_DEGC_X8 0x32
+#define HTS221_T0_T1_DEGC_H2 0x35
+#define HTS221_H0_T0_OUT_L 0x36
+#define HTS221_H1_T0_OUT_L 0x3A
+#define HTS221_T0_OUT_L 0x3C
+#define HTS221_AUTO_INCREMENT 0x80
+
+static int16_t word(const uint8_t *data) {
+    return (int16_t)(data[0] | (data[1] << 8));
+}
+
+int HTS221Sensor::readReg(uint8_t reg, uint8_t *data, uint16_t length) {
+    if (length > 1) {
+        reg |= HTS221_AUTO_INCREMENT;
+    }
+    return devI2c.i2c_read(data, HTS221_I2C_ADDRESS, reg, length);
+}
+
+int HTS221Sensor::writeReg(uint8_t reg, uint8_t value) {
+    return devI2c.i2c_write(&value, HTS221_I2C_ADDRESS, reg, 1);
+}
+
+// 1 Hz output data rate with block data update
+int HTS221Sensor::init(void * /* init */) {
+    uint8_t ctrl;
+    if (readReg(HTS221_CTRL_REG1, &ctrl, 1) != 0) {
+        return 1;
+    }
+    return writeReg(HTS221_CTRL_REG1, (ctrl & ~0x07) | 0x05);
+}
+
+int HTS221Sensor::enable() {
+    uint8_t ctrl;
+    if (readReg(HTS221_CTRL_REG1, &ctrl, 1) != 0) {
+        return 1;
+    }
+    return writeReg(HTS221_CTRL_REG1, ctrl | 0x80);
+}
+
+// reboots the calibration memory
+int HTS221Sensor::reset() {
+    uint8_t ctrl;
+    if (readReg(HTS221_CTRL_REG2, &ctrl, 1) != 0) {
+        return 1;
+    }
+    return writeReg(HTS221_CTRL_REG2, ctrl | 0x80);
+}
+
+// the output interpolated between the two factory calibration points
+int HTS221Sensor::getHumidity(float *humidity) {
+    uint8_t buffer[2];
+    if (readReg(HTS221_H0_RH_X2, buffer, 2) != 0) {
+        return 1;
+    }
+    int h0 = buffer[0] >> 1;
+    int h1 = buffer[1] >> 1;
+    if (readReg(HTS221_H0_T0_OUT_L, buffer, 2) != 0) {
+        return 1;
+    }
+    int h0Out = word(buffer);
+    if (readReg(HTS221_H1_T0_OUT_L, buffer, 2) != 0) {
+        return 1;
+    }
+    int h1Out = word(buffer);
+    if (readReg(HTS221_HR_OUT_L, buffer, 2) != 0) {
+        return 1;
+    }
+    int out = word(buffer);
+
+    if (h1Out == h0Out) {
+        return 1;
+    }
+    *humidity = (float)(h1 - h0) * (out - h0Out) / (h1Out - h0Out) + h0;
+    return 0;
+}
+
+int HTS221Sensor::getTemperature(float *temperature) {
+    uint8_t buffer[4];
+    uint8_t msb;
+    if (readReg(HTS221_T0_DEGC_X8, buffer, 2) != 0 || readReg(HTS221_T0_T1_DEGC_H2, &msb, 1) != 0) {
+        return 1;
+    }
+    int t0 = (buffer[0] | ((msb & 0x03) << 8)) >> 3;
+    int t1 = (buffer[1] | ((msb & 0x0C) << 6)) >> 3;
+    if (readReg(HTS221_T0_OUT_L, buffer, 4) != 0) {
+        return 1;
+    }
+    int t0Out = word(buffer);
+    int t1Out = word(buffer + 2);
+    if (readReg(HTS221_TEMP_OUT_L, buffer, 2) != 0) {
+        return 1;
+    }
+    int out = word(buffer);
+
+    if (t1Out == t0Out) {
+        return 1;
+    }
+    *temperature = (float)(t1 - t0) * (out - t0Out) / (t1Out - t0Out) + t0;
+    return 0;
+}
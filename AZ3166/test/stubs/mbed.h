@@ -0,0 +1,142 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+// single threaded host stand-ins for the mbed RTOS primitives, they keep the same
+// capacities and return codes so the bounded paths can be tested
+
+#ifndef HOST_MBED_H
+#define HOST_MBED_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+typedef enum {
+    osOK = 0,
+    osEventMessage = 0x10,
+    osEventTimeout = 0x40,
+    osErrorResource = 0x81,
+    osErrorParameter = 0x80
+} osStatus;
+
+typedef enum {
+    osPriorityLow = -1,
+    osPriorityNormal = 0
+} osPriority;
+
+typedef struct {
+    osStatus status;
+    union {
+        uint32_t v;
+        void *p;
+    } value;
+} osEvent;
+
+typedef void *osThreadId;
+
+#define osWaitForever 0xFFFFFFFF
+
+osThreadId osThreadGetId();
+void hostSetThreadId(osThreadId id);
+
+// from the Arduino stand-in, waits that time out move the host clock
+void hostAdvanceMillis(unsigned long ms);
+
+// counts lock calls so tests can check the lock is taken, checks it is always released
+class Mutex {
+public:
+    Mutex() : depth(0), locks(0) {}
+    osStatus lock(uint32_t /* millisec */ = osWaitForever) { depth++; locks++; return osOK; }
+    osStatus unlock() { depth--; return osOK; }
+    int depth;
+    unsigned long locks;
+};
+
+class Semaphore {
+public:
+    Semaphore(int32_t count = 0) : tokens(count) {}
+    int32_t wait(uint32_t /* millisec */ = osWaitForever) {
+        if (tokens > 0) {
+            return tokens--;
+        }
+        return 0;
+    }
+    osStatus release() { tokens++; return osOK; }
+    int32_t tokens;
+};
+
+template<typename T, uint32_t pool_sz>
+class MemoryPool {
+public:
+    MemoryPool() { for (uint32_t i = 0; i < pool_sz; i++) used[i] = false; }
+    T *alloc() {
+        for (uint32_t i = 0; i < pool_sz; i++) {
+            if (!used[i]) {
+                used[i] = true;
+                return &blocks[i];
+            }
+        }
+        return NULL;
+    }
+    T *calloc() {
+        T *block = alloc();
+        if (block != NULL) {
+            memset(block, 0, sizeof(T));
+        }
+        return block;
+    }
+    osStatus free(T *block) {
+        if (block < blocks || block >= blocks + pool_sz) {
+            return osErrorParameter;
+        }
+        used[block - blocks] = false;
+        return osOK;
+    }
+private:
+    T blocks[pool_sz];
+    bool used[pool_sz];
+};
+
+template<typename T, uint32_t queue_sz>
+class Queue {
+public:
+    Queue() : head(0), count(0) {}
+    osStatus put(T *data, uint32_t /* millisec */ = 0) {
+        if (count == queue_sz) {
+            return osErrorResource;
+        }
+        items[(head + count++) % queue_sz] = data;
+        return osOK;
+    }
+    osEvent get(uint32_t millisec = osWaitForever) {
+        osEvent evt;
+        if (count == 0) {
+            if (millisec != osWaitForever) {
+                hostAdvanceMillis(millisec);
+            }
+            evt.status = osEventTimeout;
+            evt.value.p = NULL;
+            return evt;
+        }
+        evt.status = osEventMessage;
+        evt.value.p = items[head];
+        head = (head + 1) % queue_sz;
+        count--;
+        return evt;
+    }
+private:
+    T *items[queue_sz];
+    uint32_t head;
+    uint32_t count;
+};
+
+// a started thread runs to completion inside start, so a test ends a thread loop
+// from one of the stand-ins the loop calls
+class Thread {
+public:
+    Thread(osPriority /* priority */ = osPriorityNormal, uint32_t /* stack_size */ = 0) {}
+    osStatus start(void (*task)(void)) { task(); return osOK; }
+    osStatus join() { return osOK; }
+};
+
+#endif /* HOST_MBED_H */
@@ -0,0 +1,174 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/telemetryQueue.h"
+#include "../inc/stats.h"
+
+#include "testing.h"
+
+// stand-in for DevKitMQTTClient_SendEventInstance, records what went out while online
+static bool online = true;
+static int sentCount = 0;
+static char sent[64][TELEMETRY_PAYLOAD_MAX];
+
+static bool sendEvent(const char *payload) {
+    if (!online) {
+        return false;
+    }
+    if (sentCount < 64) {
+        strcpy(sent[sentCount], payload);
+    }
+    sentCount++;
+    return true;
+}
+
+// the worker's drain loop, the record stays queued until the send succeeds
+static int drain() {
+    static TELEMETRY_RECORD record;
+    int drained = 0;
+
+    while (telemetryQueueCopyOldest(&record)) {
+        if (!sendEvent(record.payload)) {
+            break;
+        }
+        telemetryQueueRelease(record.sequence);
+        drained++;
+    }
+    return drained;
+}
+
+static void pushSample(int i) {
+    char payload[32];
+    int length = snprintf(payload, sizeof(payload), "{\"sample\":%d}", i);
+    CHECK(telemetryQueuePush(payload, length, 1500000000 + i, TELEMETRY_JSON));
+}
+
+static void reset() {
+    telemetryQueueClear();
+    clearCounters();
+    online = true;
+    sentCount = 0;
+}
+
+static void testDrainsInOrderAfterReconnect() {
+    reset();
+    online = false;
+    for (int i = 0; i < 5; i++) {
+        pushSample(i);
+        CHECK_EQUAL_INT(0, drain());
+    }
+    CHECK_EQUAL_INT(5, telemetryQueueCount());
+
+    online = true;
+    CHECK_EQUAL_INT(5, drain());
+    CHECK_EQUAL_INT(0, telemetryQueueCount());
+    for (int i = 0; i < 5; i++) {
+        char expected[32];
+        snprintf(expected, sizeof(expected), "{\"sample\":%d}", i);
+        CHECK_EQUAL_TEXT(expected, sent[i]);
+    }
+    CHECK_EQUAL_INT(0, getDroppedCount());
+}
+
+static void testDropsOldestWhenFull() {
+    reset();
+    online = false;
+    for (int i = 0; i < TELEMETRY_QUEUE_DEPTH + 3; i++) {
+        pushSample(i);
+    }
+    CHECK_EQUAL_INT(TELEMETRY_QUEUE_DEPTH, telemetryQueueCount());
+    CHECK_EQUAL_INT(3, getDroppedCount());
+
+    online = true;
+    CHECK_EQUAL_INT(TELEMETRY_QUEUE_DEPTH, drain());
+    CHECK_EQUAL_TEXT("{\"sample\":3}", sent[0]);
+}
+
+static void testOversizedPayloadRejected() {
+    reset();
+    static char payload[TELEMETRY_PAYLOAD_MAX + 1];
+    memset(payload, 'x', TELEMETRY_PAYLOAD_MAX);
+    payload[TELEMETRY_PAYLOAD_MAX] = 0;
+    CHECK(!telemetryQueuePush(payload, TELEMETRY_PAYLOAD_MAX, 0, TELEMETRY_JSON));
+    CHECK_EQUAL_INT(0, telemetryQueueCount());
+}
+
+// a record overwritten while it was being sent must not take a newer one with it
+static void testReleaseAfterOverwrite() {
+    reset();
+    TELEMETRY_RECORD record;
+    for (int i = 0; i < TELEMETRY_QUEUE_DEPTH; i++) {
+        pushSample(i);
+    }
+    CHECK(telemetryQueueCopyOldest(&record));
+    pushSample(100);
+    telemetryQueueRelease(record.sequence);
+    CHECK_EQUAL_INT(TELEMETRY_QUEUE_DEPTH, telemetryQueueCount());
+
+    CHECK(telemetryQueueCopyOldest(&record));
+    CHECK_EQUAL_TEXT("{\"sample\":1}", record.payload);
+}
+
+static void testBatch() {
+    reset();
+    for (int i = 0; i < 4; i++) {
+        pushSample(i);
+    }
+
+    char buffer[512];
+    TELEMETRY_BATCH batch;
+    int length = telemetryQueueBuildBatch(buffer, sizeof(buffer), 3, &batch);
+    CHECK_EQUAL_INT(3, batch.records);
+    CHECK_EQUAL_INT(strlen(buffer), length);
+    CHECK_EQUAL_TEXT("[{\"timestamp\":\"2017-07-14T02:40:00Z\",\"sample\":0},"
+        "{\"timestamp\":\"2017-07-14T02:40:01Z\",\"sample\":1},"
+        "{\"timestamp\":\"2017-07-14T02:40:02Z\",\"sample\":2}]", buffer);
+
+    // a buffer too small for the whole batch takes the records that fit
+    length = telemetryQueueBuildBatch(buffer, 80, 4, &batch);
+    CHECK_EQUAL_INT(1, batch.records);
+    CHECK(length < 80);
+
+    telemetryQueueRelease(batch.lastSequence);
+    CHECK_EQUAL_INT(3, telemetryQueueCount());
+
+    // a record that cannot fit even on its own is dropped and counted instead of blocking the ring
+    CHECK_EQUAL_INT(-1, telemetryQueueBuildBatch(buffer, 20, 4, &batch));
+    CHECK_EQUAL_INT(2, telemetryQueueCount());
+    CHECK_EQUAL_INT(1, getDroppedCount());
+    CHECK(telemetryQueueBuildBatch(buffer, sizeof(buffer), 4, &batch) > 0);
+    CHECK_EQUAL_INT(2, batch.records);
+}
+
+static void benchmark() {
+    const int rounds = 200000;
+    reset();
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        pushSample(i);
+        if (i % TELEMETRY_QUEUE_DEPTH == TELEMETRY_QUEUE_DEPTH - 1) {
+            drain();
+        }
+    }
+    drain();
+    double micros = elapsedMicros(start);
+
+    CHECK_EQUAL_INT(rounds, sentCount);
+    CHECK_EQUAL_INT(0, getDroppedCount());
+    printf("%d records through the ring: %.3f us per enqueue + dequeue, footprint %u bytes (%d x %u)\n",
+        rounds, micros / rounds, (unsigned)(TELEMETRY_QUEUE_DEPTH * sizeof(TELEMETRY_RECORD)),
+        TELEMETRY_QUEUE_DEPTH, (unsigned)sizeof(TELEMETRY_RECORD));
+}
+
+int main() {
+    testDrainsInOrderAfterReconnect();
+    testDropsOldestWhenFull();
+    testOversizedPayloadRejected();
+    testReleaseAfterOverwrite();
+    testBatch();
+    benchmark();
+    return testResult("telemetryQueueTest");
+}
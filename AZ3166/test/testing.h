@@ -0,0 +1,49 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#ifndef TESTING_H
+#define TESTING_H
+
+#include <stdio.h>
+#include <chrono>
+
+// every failed check is printed, the test exits with the number of failures
+static int testFailures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            testFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQUAL_INT(expected, actual) \
+    do { \
+        long long e = (long long)(expected); \
+        long long a = (long long)(actual); \
+        if (e != a) { \
+            printf("%s:%d: expected %s == %lld, got %lld\n", __FILE__, __LINE__, #actual, e, a); \
+            testFailures++; \
+        } \
+    } while (0)
+
+#define CHECK_EQUAL_TEXT(expected, actual) \
+    do { \
+        if (strcmp((expected), (actual)) != 0) { \
+            printf("%s:%d: expected \"%s\", got \"%s\"\n", __FILE__, __LINE__, (expected), (actual)); \
+            testFailures++; \
+        } \
+    } while (0)
+
+static int testResult(const char *name) {
+    printf("%s: %s\n", name, testFailures == 0 ? "passed" : "FAILED");
+    return testFailures == 0 ? 0 : 1;
+}
+
+// wall clock for the benchmarks, they report and never fail a test on timing
+static inline double elapsedMicros(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif /* TESTING_H */
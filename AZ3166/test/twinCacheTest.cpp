@@ -0,0 +1,114 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/iotCentral.h"
+#include "../inc/config.h"
+#include "../inc/twinCache.h"
+#include "../inc/utility.h"
+
+#include "testing.h"
+
+// stand-in for the twin cache EEPROM zone, survives the simulated reboots
+static uint8_t eepromZone[TWIN_CACHE_MAX_LEN];
+static int eepromWrites = 0;
+
+void storeTwinCache(const uint8_t *twinCache, int size) {
+    memcpy(eepromZone, twinCache, size < TWIN_CACHE_MAX_LEN ? size : TWIN_CACHE_MAX_LEN);
+    eepromWrites++;
+}
+
+void readTwinCache(uint8_t *twinCache, int size) {
+    memcpy(twinCache, eepromZone, size < TWIN_CACHE_MAX_LEN ? size : TWIN_CACHE_MAX_LEN);
+}
+
+static void eraseZone() {
+    memset(eepromZone, 0xFF, sizeof(eepromZone));
+    eepromWrites = 0;
+}
+
+// a value applied and committed, then a reboot before its echo was acknowledged: the
+// complete twin still shows it unreported, the cache keeps its handler from running again
+static void testRebootBeforeEchoAcknowledged() {
+    eraseZone();
+    twinCacheLoad();
+    CHECK_EQUAL_INT(0, twinCacheVersion());
+    CHECK(!twinCacheMatches("fanSpeed", "1200"));
+
+    twinCacheUpdate("fanSpeed", "1200");
+    twinCacheUpdate("irOn", "true");
+    twinCacheCommit(5);
+    CHECK_EQUAL_INT(1, eepromWrites);
+
+    twinCacheLoad();
+    CHECK_EQUAL_INT(5, twinCacheVersion());
+    CHECK(twinCacheMatches("fanSpeed", "1200"));
+    CHECK(twinCacheMatches("irOn", "true"));
+
+    // a value changed while the device was off runs its handler
+    CHECK(!twinCacheMatches("fanSpeed", "900"));
+    CHECK(!twinCacheMatches("voltage", "1200"));
+}
+
+// nothing new to remember is not written again, the EEPROM has limited write cycles
+static void testCommitOnlyWhenChanged() {
+    eraseZone();
+    twinCacheLoad();
+    twinCacheUpdate("fanSpeed", "1200");
+    twinCacheCommit(5);
+    twinCacheCommit(5);
+    CHECK_EQUAL_INT(1, eepromWrites);
+
+    twinCacheUpdate("fanSpeed", "900");
+    twinCacheCommit(5);
+    CHECK_EQUAL_INT(2, eepromWrites);
+    twinCacheCommit(6);
+    CHECK_EQUAL_INT(3, eepromWrites);
+}
+
+// properties past the cache size are not remembered, their handlers run again after a reboot
+static void testCacheFull() {
+    char name[16];
+    eraseZone();
+    twinCacheLoad();
+    for (int i = 0; i <= TWIN_CACHE_MAX_ENTRIES; i++) {
+        snprintf(name, sizeof(name), "p%d", i);
+        twinCacheUpdate(name, "1");
+    }
+    twinCacheCommit(2);
+    twinCacheLoad();
+
+    snprintf(name, sizeof(name), "p%d", TWIN_CACHE_MAX_ENTRIES - 1);
+    CHECK(twinCacheMatches(name, "1"));
+    snprintf(name, sizeof(name), "p%d", TWIN_CACHE_MAX_ENTRIES);
+    CHECK(!twinCacheMatches(name, "1"));
+}
+
+// a zone written by other firmware starts an empty cache
+static void testForeignZone() {
+    memset(eepromZone, 0x5A, sizeof(eepromZone));
+    twinCacheLoad();
+    CHECK_EQUAL_INT(0, twinCacheVersion());
+    CHECK(!twinCacheMatches("fanSpeed", "1200"));
+}
+
+// caches written by earlier firmware hold these hashes, the shared hash must not change them
+static void testHashUnchanged() {
+    CHECK_EQUAL_INT(0x811C9DC5u, hashText("", false));
+    CHECK_EQUAL_INT(0xE40C292Cu, hashText("a", false));
+    CHECK_EQUAL_INT(0xBF9CF968u, hashText("foobar", false));
+    CHECK(hashText("fanSpeed", false) != hashText("FANSPEED", false));
+
+    // method names are found whatever their case
+    CHECK_EQUAL_INT(hashText("fanspeed", false), hashText("FanSpeed", true));
+}
+
+int main() {
+    testHashUnchanged();
+    testRebootBeforeEchoAcknowledged();
+    testCommitOnlyWhenChanged();
+    testCacheFull();
+    testForeignZone();
+    return testResult("twinCacheTest");
+}
@@ -0,0 +1,86 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+// built against ArduinoJson 5 itself rather than the stub, see ARDUINOJSON_DIR in CMakeLists.txt
+#include <ArduinoJson.h>
+
+#include "Arduino.h"
+
+#include "../inc/twinDiff.h"
+
+#include "testing.h"
+
+static int changes = 0;
+static char changedNames[256];
+
+static void recordChange(const char *name, JsonObject& property, int version) {
+    changes++;
+    strncat(changedNames, name, sizeof(changedNames) - strlen(changedNames) - 2);
+    strcat(changedNames, " ");
+}
+
+static int diffTwin(char *twin) {
+    changes = 0;
+    changedNames[0] = 0;
+
+    DynamicJsonBuffer jsonBuffer;
+    JsonObject& root = jsonBuffer.parseObject(twin);
+    CHECK(root.success());
+    JsonObject& desired = root["desired"];
+    JsonObject& reported = root["reported"];
+    return twinDiff(desired, reported, recordChange);
+}
+
+// a value that fits is printed whole, one that does not is not printed at all
+static void testValueText() {
+    char value[8];
+    DynamicJsonBuffer jsonBuffer;
+    JsonObject& root = jsonBuffer.parseObject(
+        "{\"short\":{\"value\":\"abcd\"},\"long\":{\"value\":\"abcdefgh\"},\"number\":{\"value\":1200}}");
+    JsonObject& shortProperty = root["short"];
+    JsonObject& longProperty = root["long"];
+    JsonObject& numberProperty = root["number"];
+
+    CHECK(twinValueText(shortProperty, value, sizeof(value)));
+    CHECK_EQUAL_TEXT("\"abcd\"", value);
+    CHECK(twinValueText(numberProperty, value, sizeof(value)));
+    CHECK_EQUAL_TEXT("1200", value);
+    CHECK(!twinValueText(longProperty, value, sizeof(value)));
+    CHECK_EQUAL_TEXT("", value);
+}
+
+static void testChangedValues() {
+    char twin[] = "{\"desired\":{\"fanSpeed\":{\"value\":100},\"setVoltage\":{\"value\":12},\"$version\":4},"
+        "\"reported\":{\"fanSpeed\":{\"value\":100,\"status\":\"completed\"},\"setVoltage\":{\"value\":5}}}";
+
+    CHECK_EQUAL_INT(1, diffTwin(twin));
+    CHECK_EQUAL_TEXT("setVoltage ", changedNames);
+}
+
+// two long values that only differ past the bound must not compare equal by their
+// cut off text, the desired one is handed on and rejected by the handler
+static void testLongValuesNeverMatch() {
+    static char twin[4 * TWIN_DIFF_VALUE_MAX];
+    char same[TWIN_DIFF_VALUE_MAX + 16];
+    memset(same, 'x', sizeof(same) - 1);
+    same[sizeof(same) - 1] = 0;
+
+    snprintf(twin, sizeof(twin),
+        "{\"desired\":{\"label\":{\"value\":\"%sA\"},\"$version\":2},\"reported\":{\"label\":{\"value\":\"%sB\"}}}",
+        same, same);
+    CHECK_EQUAL_INT(1, diffTwin(twin));
+    CHECK_EQUAL_TEXT("label ", changedNames);
+
+    // a long reported value is not indexed, a short desired value is applied
+    snprintf(twin, sizeof(twin),
+        "{\"desired\":{\"label\":{\"value\":\"short\"},\"$version\":3},\"reported\":{\"label\":{\"value\":\"%s\"}}}",
+        same);
+    CHECK_EQUAL_INT(1, diffTwin(twin));
+}
+
+int main() {
+    testValueText();
+    testChangedValues();
+    testLongValuesNeverMatch();
+    return testResult("twinDiffTest");
+}
@@ -0,0 +1,136 @@
+// Copyright (c) Microsoft. All rights reserved.
+// Licensed under the MIT license.
+
+#include "Arduino.h"
+
+#include "../inc/twinIndex.h"
+
+#include "testing.h"
+
+#define MAX_PROPERTIES 1024
+
+// a synthetic twin, every third desired value differs from the reported one and every
+// seventh desired property is not reported at all
+static char desiredNames[MAX_PROPERTIES][24];
+static char desiredValues[MAX_PROPERTIES][24];
+static char reportedNames[MAX_PROPERTIES][24];
+static char reportedValues[MAX_PROPERTIES][24];
+static int reportedCount = 0;
+
+static void buildTwin(int properties) {
+    reportedCount = 0;
+    for (int i = 0; i < properties; i++) {
+        snprintf(desiredNames[i], sizeof(desiredNames[i]), "setting%d", i);
+        snprintf(desiredValues[i], sizeof(desiredValues[i]), "%d", i * 10);
+        if (i % 7 == 6) {
+            continue;
+        }
+        // reported in a different order than desired, as the hub does
+        int r = reportedCount++;
+        snprintf(reportedNames[r], sizeof(reportedNames[r]), "setting%d", properties - 1 - i);
+        snprintf(reportedValues[r], sizeof(reportedValues[r]), "%d", (properties - 1 - i) * 10 + ((properties - 1 - i) % 3 == 0 ? 1 : 0));
+    }
+}
+
+// the comparison the index replaced, every desired name against every reported name
+static bool linearMatches(const char *name, const char *value) {
+    for (int i = 0; i < reportedCount; i++) {
+        if (strcmp(reportedNames[i], name) == 0) {
+            return strcmp(reportedValues[i], value) == 0;
+        }
+    }
+    return false;
+}
+
+static int diffWithIndex(int properties) {
+    TWIN_INDEX index;
+    CHECK(twinIndexInit(&index, reportedCount));
+    for (int i = 0; i < reportedCount; i++) {
+        twinIndexAdd(&index, reportedNames[i], reportedValues[i]);
+    }
+    twinIndexSort(&index);
+
+    int changes = 0;
+    for (int i = 0; i < properties; i++) {
+        changes += !twinIndexMatches(&index, desiredNames[i], desiredValues[i]);
+    }
+    twinIndexFree(&index);
+    return changes;
+}
+
+static int diffLinear(int properties) {
+    int changes = 0;
+    for (int i = 0; i < properties; i++) {
+        changes += !linearMatches(desiredNames[i], desiredValues[i]);
+    }
+    return changes;
+}
+
+static void testMatchesLinearDiff() {
+    buildTwin(100);
+    TWIN_INDEX index;
+    CHECK(twinIndexInit(&index, reportedCount));
+    for (int i = 0; i < reportedCount; i++) {
+        CHECK(twinIndexAdd(&index, reportedNames[i], reportedValues[i]));
+    }
+    CHECK(!twinIndexAdd(&index, "extra", "1"));
+    twinIndexSort(&index);
+
+    for (int i = 0; i < 100; i++) {
+        CHECK(twinIndexMatches(&index, desiredNames[i], desiredValues[i]) == linearMatches(desiredNames[i], desiredValues[i]));
+    }
+    CHECK(!twinIndexMatches(&index, "setting", "0"));
+    CHECK(!twinIndexMatches(&index, "Setting1", "10"));
+    twinIndexFree(&index);
+
+    // no changes are capped, a twin larger than any fixed table is diffed completely
+    buildTwin(MAX_PROPERTIES);
+    CHECK_EQUAL_INT(diffLinear(MAX_PROPERTIES), diffWithIndex(MAX_PROPERTIES));
+    CHECK(diffWithIndex(MAX_PROPERTIES) > 32);
+}
+
+// a twin without reported properties changes every desired property
+static void testEmptyIndex() {
+    TWIN_INDEX index;
+    CHECK(twinIndexInit(&index, 0));
+    twinIndexSort(&index);
+    CHECK(!twinIndexAdd(&index, "fanSpeed", "10"));
+    CHECK(!twinIndexMatches(&index, "fanSpeed", "10"));
+    twinIndexFree(&index);
+}
+
+static void benchmark(int properties) {
+    const int rounds = 200000 / properties;
+    buildTwin(properties);
+    int expected = diffLinear(properties);
+
+    // called through volatile pointers so the compiler cannot hoist the diff out of the loop
+    int (*volatile linear)(int) = diffLinear;
+    int (*volatile indexed)(int) = diffWithIndex;
+    int changes = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        changes += linear(properties);
+    }
+    double linearMicros = elapsedMicros(start);
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rounds; i++) {
+        changes += indexed(properties);
+    }
+    double indexMicros = elapsedMicros(start);
+
+    CHECK_EQUAL_INT(2 * rounds * expected, changes);
+    printf("%4d properties: nested strcmp %.1f us per twin, sorted index %.1f us per twin\n",
+        properties, linearMicros / rounds, indexMicros / rounds);
+}
+
+int main() {
+    testMatchesLinearDiff();
+    testEmptyIndex();
+    benchmark(8);
+    benchmark(32);
+    benchmark(256);
+    benchmark(1024);
+    return testResult("twinIndexTest");
+}
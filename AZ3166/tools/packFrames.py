@@ -0,0 +1,111 @@
+# Copyright (c) Microsoft. All rights reserved.
+# Licensed under the MIT license.
+
+# Packs the ASCII animation frames in animationFrames.txt into ready to draw OLED
+# page buffers and writes them to inc/animationFrameData.h.
+#
+# usage: python tools/packFrames.py   (run from the AZ3166 folder)
+#
+# The output is checked in, the Arduino build does not run this script.  Rerun it
+# after changing animationFrames.txt or the glyphs below.
+
+import os
+import sys
+
+# must match ANIMATION_FRAME_WIDTH and ANIMATION_FRAME_BYTES in inc/oledAnimation.h
+CELLS = 8
+CELL_BYTES = 8
+ROW_PAD = 3
+ROW_STRIDE = CELLS * CELL_BYTES + 8
+FRAME_BYTES = ROW_STRIDE * 8
+
+GLYPHS = {
+    'B': [0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF],  # block
+    'G': [0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E, 0x7E],  # block with gap
+    'g': [0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00],  # block with vertical gap
+    'X': [0x81, 0x42, 0x24, 0x18, 0x18, 0x24, 0x42, 0x81],  # cross
+    'L': [0x03, 0x07, 0x0E, 0x1C, 0x38, 0x70, 0xE0, 0xC0],  # diagonal left to right
+    'R': [0xC0, 0xE0, 0x70, 0x38, 0x1C, 0x0E, 0x07, 0x03],  # diagonal right to left
+    'H': [0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80],  # horizontal top
+    'h': [0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01, 0x01],  # horizontal bottom
+    'V': [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF],  # vertical left
+    'v': [0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00],  # vertical right
+    'O': [0x18, 0x7E, 0x7E, 0xFF, 0xFF, 0x7E, 0x7E, 0x18],  # circle
+    '.': [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00],  # clear
+    'T': [0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03],  # border top
+    'b': [0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0],  # border bottom
+    '<': [0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00],  # border left
+    '>': [0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF, 0xFF],  # border right
+    '1': [0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, 0x03, 0x03],  # corner left top
+    '2': [0x03, 0x03, 0x03, 0x03, 0x03, 0x03, 0xFF, 0xFF],  # corner right top
+    '3': [0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0, 0xC0],  # corner left bottom
+    '4': [0xC0, 0x00, 0xC0, 0xC0, 0xC0, 0xC0, 0xFF, 0xFF],  # corner right bottom
+    '!': [0x00, 0xF0, 0xF8, 0xFC, 0xFC, 0xFE, 0xFE, 0xFE],  # circle left top
+    '@': [0xFE, 0xFE, 0xFE, 0xFC, 0xFC, 0xF8, 0xF0, 0x00],  # circle right top
+    '#': [0x00, 0x0F, 0x1F, 0x3F, 0x3F, 0x7F, 0x7F, 0x7F],  # circle left bottom
+    '$': [0x7F, 0x7F, 0x7F, 0x3F, 0x3F, 0x1F, 0x0F, 0x00],  # circle right bottom
+}
+
+
+def readFrames(path):
+    frames = []
+    name = None
+    rows = []
+    with open(path) as f:
+        for lineNumber, line in enumerate(f, 1):
+            line = line.rstrip('\r\n')
+            if not line or line.startswith('#'):
+                continue
+            if line.startswith('[') and line.endswith(']'):
+                name = line[1:-1]
+                rows = []
+                frames.append((name, rows))
+                continue
+            if name is None or len(line) != CELLS or len(rows) == 8:
+                sys.exit('%s:%d: expected a [name] or a row of %d cells' % (path, lineNumber, CELLS))
+            for c in line:
+                if c not in GLYPHS:
+                    sys.exit('%s:%d: unknown glyph %r' % (path, lineNumber, c))
+            rows.append(line)
+    for name, rows in frames:
+        if len(rows) != 8:
+            sys.exit('%s: frame %s has %d rows' % (path, name, len(rows)))
+    return frames
+
+
+# the same layout the renderer used to build at runtime, a 3 byte pad then each
+# cell 8 columns apart with an 8 column gap after every row of cells
+def packFrame(rows):
+    frame = [0] * FRAME_BYTES
+    for y, row in enumerate(rows):
+        for x, c in enumerate(row):
+            start = y * ROW_STRIDE + ROW_PAD + x * CELL_BYTES
+            frame[start:start + CELL_BYTES] = GLYPHS[c]
+    return frame
+
+
+def writeHeader(path, frames):
+    with open(path, 'w') as f:
+        f.write('// Copyright (c) Microsoft. All rights reserved.\n')
+        f.write('// Licensed under the MIT license.\n\n')
+        f.write('// generated by tools/packFrames.py from tools/animationFrames.txt, do not edit\n\n')
+        f.write('#ifndef ANIMATION_FRAME_DATA_H\n')
+        f.write('#define ANIMATION_FRAME_DATA_H\n\n')
+        f.write('#include "oledAnimation.h"\n')
+        for name, rows in frames:
+            frame = packFrame(rows)
+            f.write('\n')
+            for row in rows:
+                f.write('// %s\n' % row)
+            f.write('const unsigned char %sFrame[ANIMATION_FRAME_BYTES] = {\n' % name)
+            for i in range(0, FRAME_BYTES, 12):
+                f.write('    ' + ', '.join('0x%02X' % b for b in frame[i:i + 12]) + ',\n')
+            f.write('};\n')
+        f.write('\n#endif /* ANIMATION_FRAME_DATA_H */\n')
+
+
+if __name__ == '__main__':
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..')
+    frames = readFrames(os.path.join(root, 'tools', 'animationFrames.txt'))
+    writeHeader(os.path.join(root, 'inc', 'animationFrameData.h'), frames)
+    print('packed %d frames' % len(frames))